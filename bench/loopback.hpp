@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <netinet/in.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace bench {
+
+// "--key value" pairs, looked up with defaults
+class args {
+public:
+    args(int argc, char** argv) {
+        for (auto i=1; i+1<argc; i+=2) {
+            m_values[argv[i]] = argv[i + 1];
+        }
+    }
+
+    auto get(const std::string& key, const std::string& fallback) const -> std::string {
+        auto it = m_values.find(key);
+        return it == m_values.end() ? fallback : it->second;
+    }
+
+    auto get(const std::string& key, uint64_t fallback) const -> uint64_t {
+        auto it = m_values.find(key);
+        return it == m_values.end() ? fallback : std::strtoull(it->second.c_str(), nullptr, 10);
+    }
+
+private:
+    std::map<std::string, std::string> m_values;
+
+}; // class args
+
+// Non-blocking UDP socket bound to 127.0.0.1:port, configured like udp_source
+inline auto receiver_socket(uint16_t port, int recv_buf_size) -> int {
+    auto fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &recv_buf_size, sizeof(recv_buf_size));
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+        close(fd);
+        throw std::runtime_error("bind: " + std::string{std::strerror(errno)});
+    }
+    return fd;
+}
+
+/*
+ * Sends msg_size datagrams to 127.0.0.1:port from its own thread, in bursts of
+ * sendmmsg, optionally paced to a packet rate. The first 8 bytes of each
+ * datagram carry the send time in steady_clock nanoseconds.
+ */
+class sender {
+    static constexpr std::size_t BURST = 32;
+public:
+    sender(uint16_t port, std::size_t msg_size, uint64_t rate_pps = 0) {
+        m_thread = std::jthread([=, this](std::stop_token token) { run(token, port, msg_size, rate_pps); });
+    }
+
+    auto sent() const -> uint64_t {
+        return m_sent.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> m_sent{};
+    std::jthread m_thread;
+
+    auto run(std::stop_token token, uint16_t port, std::size_t msg_size, uint64_t rate_pps) -> void {
+        auto fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        struct sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        auto burst = rate_pps == 0 ? BURST : 1;
+        auto buffer = std::vector<uint8_t>(burst * msg_size, 0xA5);
+        auto iovecs = std::vector<struct iovec>(burst);
+        auto msgs = std::vector<struct mmsghdr>(burst);
+        for (auto i=0u; i<burst; ++i) {
+            iovecs.at(i) = {buffer.data() + (i * msg_size), msg_size};
+            msgs.at(i).msg_hdr.msg_iov = &iovecs.at(i);
+            msgs.at(i).msg_hdr.msg_iovlen = 1;
+        }
+        auto period = rate_pps == 0 ? std::chrono::nanoseconds{0} : std::chrono::nanoseconds{1'000'000'000 / rate_pps};
+        auto next = std::chrono::steady_clock::now();
+        while (!token.stop_requested()) {
+            if (rate_pps != 0) {
+                while (std::chrono::steady_clock::now() < next) {}
+                next += period;
+            }
+            auto stamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+            for (auto i=0u; i<burst; ++i) {
+                std::memcpy(buffer.data() + (i * msg_size), &stamp, std::min(sizeof(stamp), msg_size));
+            }
+            if (auto num_sent = sendmmsg(fd, msgs.data(), burst, 0); num_sent > 0) {
+                m_sent.fetch_add(num_sent, std::memory_order_relaxed);
+            }
+        }
+        close(fd);
+    }
+
+}; // class sender
+
+} // namespace bench
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/*
+ * VITA-49 overlay parse rate: the previous string-keyed field table against
+ * the fixed layout, with and without the per-stream layout cache.
+ *
+ *   overlay_bench [--packets 4096] [--msg_size 1044] [--streams 1] [--seconds 2]
+ *
+ * Each datagram is a signal data packet with stream ID, class ID, integer and
+ * fractional timestamps and a trailer; streams differ only in stream ID.
+ */
+
+#include "loopback.hpp"
+
+#include <overlay.hpp>
+
+#include <chrono>
+#include <complex>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace legacy {
+
+// overlay::v49::overlay before the fixed layout
+class overlay {
+public:
+    explicit overlay(std::span<const uint8_t> data) :
+      m_data(data) {
+        m_header.unpack_from(m_data.data());
+        auto curr_idx = m_header.size();
+        if (m_header.packet_type() != vrtgen::packing::PacketType::SIGNAL_DATA) {
+            m_positions["stream_id"] = curr_idx;
+            curr_idx += sizeof(uint32_t); // stream_id
+        }
+        if (m_header.class_id_enable()) {
+            m_positions["class_id"] = curr_idx;
+            curr_idx += 8; // bytes, class_id
+        }
+        if (m_header.tsi() != vrtgen::packing::TSI::NONE) {
+            m_positions["integer_timestamp"] = curr_idx;
+            curr_idx += sizeof(uint32_t); // integer_timestamp
+        }
+        if (m_header.tsf() != vrtgen::packing::TSF::NONE) {
+            m_positions["fractional_timestamp"] = curr_idx;
+            curr_idx += sizeof(uint64_t); // fractional_timestamp
+        }
+        if (::overlay::v49::is_data(m_header)) {
+            m_positions["payload"] = curr_idx;
+            auto data_header = vrtgen::packing::DataHeader{};
+            data_header.unpack_from(m_data.data());
+            if (data_header.trailer_included()) {
+                m_positions["trailer"] = (m_header.packet_size() - 1) * sizeof(uint32_t)/*word size*/;
+            }
+        }
+    }
+
+    auto header() const -> const vrtgen::packing::Header& {
+        return m_header;
+    }
+
+    // 4 bit per-stream packet count from the header
+    auto packet_count() const -> uint8_t {
+        return m_header.packet_count();
+    }
+
+    auto stream_id() const -> std::optional<uint32_t> {
+        if (!m_positions.contains("stream_id")) {
+            return {};
+        }
+        auto pos = m_positions.at("stream_id");
+        return vrtgen::swap::from_be(*reinterpret_cast<const uint32_t*>(m_data.data() + pos));
+    }
+
+    auto class_id() const -> std::optional<vrtgen::packing::ClassIdentifier> {
+        if (!m_positions.contains("class_id")) {
+            return {};
+        }
+        auto pos = m_positions.at("class_id");
+        auto class_id = vrtgen::packing::ClassIdentifier{};
+        class_id.unpack_from(m_data.data() + pos);
+        return class_id;
+    }
+
+    auto integer_timestamp() const -> std::optional<uint32_t> {
+        if (!m_positions.contains("integer_timestamp")) {
+            return {};
+        }
+        auto pos = m_positions.at("integer_timestamp");
+        return vrtgen::swap::from_be(*reinterpret_cast<const uint32_t*>(m_data.data() + pos));
+    }
+
+    auto fractional_timestamp() const -> std::optional<uint64_t> {
+        if (!m_positions.contains("fractional_timestamp")) {
+            return {};
+        }
+        auto pos = m_positions.at("fractional_timestamp");
+        return vrtgen::swap::from_be(*reinterpret_cast<const uint64_t*>(m_data.data() + pos));
+    }
+
+    template<typename T>
+    auto payload() const -> std::span<const T> {
+        if (!m_positions.contains("payload")) {
+            return {};
+        }
+        auto pos = m_positions.at("payload");
+        auto data = reinterpret_cast<const T*>(m_data.data() + pos);
+        return std::span<const T>(data, payload_size() / sizeof(T));
+    }
+
+    auto payload_size() const -> size_t {
+        if (!m_positions.contains("payload")) {
+            return {};
+        }
+        auto size = (m_header.packet_size() * sizeof(uint32_t)/*word size*/) - m_positions.at("payload");
+        if (m_positions.contains("trailer")) {
+            size -= sizeof(uint32_t);
+        }
+        return size;
+    }
+
+private:
+    std::span<const uint8_t> m_data;
+    vrtgen::packing::Header m_header;
+    std::map<std::string, std::size_t> m_positions;
+
+}; // class overlay
+
+} // namespace legacy
+
+namespace {
+
+auto make_packets(std::size_t num_packets, std::size_t msg_size, uint32_t num_streams) -> std::vector<uint8_t> {
+    auto buffer = std::vector<uint8_t>(num_packets * msg_size);
+    // type 1 (data with stream ID), C, T, TSI UTC, TSF real time
+    auto word = uint32_t{0x1C600000} | static_cast<uint32_t>(msg_size / sizeof(uint32_t));
+    for (auto i=0u; i<num_packets; ++i) {
+        auto packet = buffer.data() + (i * msg_size);
+        auto header = vrtgen::swap::to_be(word | ((i & 0x0F) << 16));
+        auto stream_id = vrtgen::swap::to_be(static_cast<uint32_t>(i % num_streams));
+        std::memcpy(packet, &header, sizeof(header));
+        std::memcpy(packet + 4, &stream_id, sizeof(stream_id));
+    }
+    return buffer;
+}
+
+template <typename Parse>
+auto run(const char* name, const std::vector<uint8_t>& buffer, std::size_t msg_size, std::chrono::seconds duration, Parse parse) -> void {
+    auto num_packets = buffer.size() / msg_size;
+    auto parsed = uint64_t{};
+    auto checksum = uint64_t{};
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + duration;
+    while (std::chrono::steady_clock::now() < deadline) {
+        for (auto i=0u; i<num_packets; ++i) {
+            checksum += parse(std::span<const uint8_t>(buffer.data() + (i * msg_size), msg_size));
+        }
+        parsed += num_packets;
+    }
+    auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-14s %8.2f Mpkt/s  (checksum %llu)\n", name, static_cast<double>(parsed) / secs / 1e6,
+        static_cast<unsigned long long>(checksum));
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    auto opts = bench::args(argc, argv);
+    auto num_packets = opts.get("--packets", uint64_t{4096});
+    auto msg_size = opts.get("--msg_size", uint64_t{1044});
+    auto num_streams = static_cast<uint32_t>(std::max(opts.get("--streams", uint64_t{1}), uint64_t{1}));
+    auto duration = std::chrono::seconds(opts.get("--seconds", uint64_t{2}));
+    auto buffer = make_packets(num_packets, msg_size, num_streams);
+    using sample_t = std::complex<int16_t>;
+    run("map (before)", buffer, msg_size, duration, [](std::span<const uint8_t> data) {
+        auto packet = legacy::overlay(data);
+        if (!overlay::v49::is_data(packet.header())) {
+            return uint64_t{};
+        }
+        return packet.payload<sample_t>().size() + packet.stream_id().value_or(0);
+    });
+    run("layout", buffer, msg_size, duration, [](std::span<const uint8_t> data) {
+        auto packet = overlay::v49::overlay(data);
+        if (!packet.is_data()) {
+            return uint64_t{};
+        }
+        return packet.payload<sample_t>().size() + packet.stream_id().value_or(0);
+    });
+    auto cache = overlay::v49::layout_cache{};
+    run("layout cached", buffer, msg_size, duration, [&cache](std::span<const uint8_t> data) {
+        auto packet = overlay::v49::overlay(data, cache);
+        if (!packet.is_data()) {
+            return uint64_t{};
+        }
+        return packet.payload<sample_t>().size() + packet.stream_id().value_or(0);
+    });
+    return 0;
+}
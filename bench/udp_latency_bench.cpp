@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/*
+ * Loopback ingest latency of the udp_source recvmmsg path, sleeping in poll()
+ * versus busy polling.
+ *
+ *   udp_latency_bench [--mode poll|busy_poll|all] [--seconds 5] [--port 9999]
+ *                     [--rate 10000] [--msg_size 1044] [--num_msgs 8]
+ *                     [--busy_poll_us 50] [--cpu N]
+ *
+ * A paced sender stamps each datagram with its send time; the receiver takes
+ * the difference on receipt and reports the latency distribution. --cpu pins
+ * the receiving thread.
+ *
+ * The receive is that of udp_source::process_mmsgs without adaptive
+ * batching: the socket is non-blocking, as the component's is, and each
+ * recvmmsg takes up to num_msgs datagrams, after poll() or, when busy
+ * polling, spinning on the receive itself. Only batches that received
+ * something are rearmed. The component rearms them on its filler thread;
+ * here it happens on the receiving thread after the latencies are taken,
+ * so it only delays the next receive.
+ */
+
+#include "loopback.hpp"
+
+#include <mmsgs.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct config {
+    uint16_t port;
+    uint32_t msg_size;
+    uint32_t num_msgs;
+    uint64_t rate;
+    uint32_t busy_poll_us;
+    int cpu;
+    std::chrono::seconds duration;
+};
+
+constexpr int RECV_BUF_SIZE = 1 << 25;
+
+auto now_ns() -> uint64_t {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// udp_source::process_mmsgs with and without busy_poll
+auto run(const config& cfg, bool busy_poll) -> std::vector<uint64_t> {
+    if (cfg.cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cfg.cpu, &cpus);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+    auto fd = bench::receiver_socket(cfg.port, RECV_BUF_SIZE);
+    if (busy_poll) {
+        auto usecs = static_cast<int>(cfg.busy_poll_us);
+        auto prefer = int{1};
+        setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs));
+        setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer));
+    }
+    auto msgs = udpsrc::net::mmsgs(cfg.num_msgs, cfg.msg_size);
+    auto pfd = pollfd{.fd = fd, .events = POLLIN, .revents = 0};
+    auto latencies = std::vector<uint64_t>{};
+    latencies.reserve(cfg.rate * static_cast<uint64_t>(cfg.duration.count()));
+    auto tx = bench::sender(cfg.port, cfg.msg_size, cfg.rate);
+    auto deadline = std::chrono::steady_clock::now() + cfg.duration;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (!busy_poll && (poll(&pfd, 1, 100) <= 0 || (pfd.revents & POLLIN) == 0)) {
+            continue;
+        }
+        auto timeout = timespec{.tv_sec = 1, .tv_nsec = 0};
+        auto recvd = recvmmsg(fd, msgs.msgs.data(), msgs.msgs.size(), 0, &timeout);
+        if (recvd <= 0) {
+            continue;
+        }
+        auto received = now_ns();
+        for (auto i=0; i<recvd; ++i) {
+            auto sent = uint64_t{};
+            std::memcpy(&sent, msgs.buffer.data() + (static_cast<std::size_t>(i) * cfg.msg_size), sizeof(sent));
+            latencies.push_back(received - sent);
+        }
+        msgs.rearm();
+    }
+    close(fd);
+    return latencies;
+}
+
+auto report(const char* mode, std::vector<uint64_t> latencies) -> void {
+    if (latencies.empty()) {
+        std::printf("%-10s no datagrams received\n", mode);
+        return;
+    }
+    std::ranges::sort(latencies);
+    auto at = [&latencies](double quantile) {
+        auto idx = static_cast<std::size_t>(quantile * static_cast<double>(latencies.size() - 1));
+        return static_cast<double>(latencies.at(idx)) / 1e3;
+    };
+    std::printf(
+        "%-10s %9zu pkts  p50 %8.1f us  p90 %8.1f us  p99 %8.1f us  p99.9 %8.1f us  max %9.1f us\n",
+        mode,
+        latencies.size(),
+        at(0.5),
+        at(0.9),
+        at(0.99),
+        at(0.999),
+        at(1.0)
+    );
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    auto opts = bench::args(argc, argv);
+    auto mode = opts.get("--mode", std::string{"all"});
+    auto cpu = opts.get("--cpu", std::string{});
+    auto cfg = config{
+        .port = static_cast<uint16_t>(opts.get("--port", uint64_t{9999})),
+        .msg_size = static_cast<uint32_t>(opts.get("--msg_size", uint64_t{1044})),
+        .num_msgs = static_cast<uint32_t>(opts.get("--num_msgs", uint64_t{8})),
+        .rate = std::max(opts.get("--rate", uint64_t{10000}), uint64_t{1}),
+        .busy_poll_us = static_cast<uint32_t>(opts.get("--busy_poll_us", uint64_t{50})),
+        .cpu = cpu.empty() ? -1 : std::stoi(cpu),
+        .duration = std::chrono::seconds(opts.get("--seconds", uint64_t{5}))
+    };
+    if (mode == "poll" || mode == "all") {
+        report("poll", run(cfg, false));
+    }
+    if (mode == "busy_poll" || mode == "all") {
+        report("busy_poll", run(cfg, true));
+    }
+    return 0;
+}
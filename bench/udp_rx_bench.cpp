@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/*
+ * Loopback receive throughput of the udp_source receive paths.
+ *
+ *   udp_rx_bench [--mode recvmmsg|io_uring|all] [--seconds 5] [--port 9999]
+ *                [--msg_size 1044] [--num_msgs 64] [--pool_size 16]
+ *
+ * A sender thread floods 127.0.0.1:port with sendmmsg while the selected path
+ * receives for the given time. Each received batch is released immediately,
+ * so buffers recycle as they would behind a fast consumer.
+ */
+
+#include "loopback.hpp"
+
+#include <mmsgs.hpp>
+#ifdef UDP_SOURCE_IO_URING
+#include <uring_receiver.hpp>
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <poll.h>
+#include <string>
+
+namespace {
+
+struct result {
+    uint64_t packets{};
+    uint64_t bytes{};
+    uint64_t batches{};
+    uint64_t sent{};
+};
+
+struct config {
+    uint16_t port;
+    uint32_t msg_size;
+    uint32_t num_msgs;
+    uint32_t pool_size;
+    std::chrono::seconds duration;
+};
+
+constexpr int RECV_BUF_SIZE = 1 << 25;
+
+// Mirrors udp_source::process_mmsgs: poll, then recvmmsg into a pooled batch
+auto run_recvmmsg(const config& cfg) -> result {
+    auto fd = bench::receiver_socket(cfg.port, RECV_BUF_SIZE);
+    auto pool = std::make_shared<udpsrc::net::mmsgs_pool>(cfg.pool_size, cfg.num_msgs, cfg.msg_size);
+    auto pfd = pollfd{.fd = fd, .events = POLLIN, .revents = 0};
+    auto res = result{};
+    auto tx = bench::sender(cfg.port, cfg.msg_size);
+    auto deadline = std::chrono::steady_clock::now() + cfg.duration;
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto msgs = pool->acquire(std::chrono::seconds(1));
+        msgs->rearm();
+        if (poll(&pfd, 1, 100) <= 0 || (pfd.revents & POLLIN) == 0) {
+            pool->share(std::move(msgs));
+            continue;
+        }
+        auto recvd = recvmmsg(fd, msgs->msgs.data(), msgs->msgs.size(), 0, nullptr);
+        for (auto i=0; i<recvd; ++i) {
+            msgs->batch.push_back(static_cast<std::size_t>(i) * cfg.msg_size, msgs->msgs.at(i).msg_len);
+            res.bytes += msgs->msgs.at(i).msg_len;
+        }
+        if (recvd > 0) {
+            res.packets += recvd;
+            ++res.batches;
+        }
+        pool->share(std::move(msgs));
+    }
+    res.sent = tx.sent();
+    close(fd);
+    return res;
+}
+
+#ifdef UDP_SOURCE_IO_URING
+// Mirrors udp_source::process_uring
+auto run_uring(const config& cfg) -> result {
+    auto fd = bench::receiver_socket(cfg.port, RECV_BUF_SIZE);
+    auto receiver = std::make_shared<udpsrc::net::uring_receiver>(fd, cfg.msg_size, cfg.num_msgs, cfg.pool_size);
+    auto res = result{};
+    auto tx = bench::sender(cfg.port, cfg.msg_size);
+    auto deadline = std::chrono::steady_clock::now() + cfg.duration;
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto data = receiver->receive(std::chrono::milliseconds(100));
+        if (data == nullptr) {
+            continue;
+        }
+        for (auto i=0u; i<data->size(); ++i) {
+            res.bytes += (*data)[i].size();
+        }
+        res.packets += data->size();
+        ++res.batches;
+    }
+    res.sent = tx.sent();
+    receiver.reset();
+    close(fd);
+    return res;
+}
+#endif
+
+auto report(const char* mode, const config& cfg, const result& res) -> void {
+    auto secs = static_cast<double>(cfg.duration.count());
+    std::printf(
+        "%-10s %12.0f pkt/s %10.1f MB/s  avg batch %6.1f  received %5.1f%% of sent\n",
+        mode,
+        static_cast<double>(res.packets) / secs,
+        static_cast<double>(res.bytes) / secs / 1e6,
+        res.batches == 0 ? 0.0 : static_cast<double>(res.packets) / static_cast<double>(res.batches),
+        res.sent == 0 ? 0.0 : 100.0 * static_cast<double>(res.packets) / static_cast<double>(res.sent)
+    );
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    auto opts = bench::args(argc, argv);
+    auto mode = opts.get("--mode", std::string{"all"});
+    auto cfg = config{
+        .port = static_cast<uint16_t>(opts.get("--port", uint64_t{9999})),
+        .msg_size = static_cast<uint32_t>(opts.get("--msg_size", uint64_t{1044})),
+        .num_msgs = static_cast<uint32_t>(opts.get("--num_msgs", uint64_t{64})),
+        .pool_size = static_cast<uint32_t>(opts.get("--pool_size", uint64_t{16})),
+        .duration = std::chrono::seconds(opts.get("--seconds", uint64_t{5}))
+    };
+    if (mode == "recvmmsg" || mode == "all") {
+        report("recvmmsg", cfg, run_recvmmsg(cfg));
+    }
+#ifdef UDP_SOURCE_IO_URING
+    if (mode == "io_uring" || mode == "all") {
+        report("io_uring", cfg, run_uring(cfg));
+    }
+#else
+    if (mode == "io_uring") {
+        std::fprintf(stderr, "built without io_uring support\n");
+        return 1;
+    }
+#endif
+    return 0;
+}
@@ -19,8 +19,13 @@
 
 #pragma once
 
+#include <aligned_pool.hpp>
+#include <stream_context_fwd.hpp>
+
 #include <algorithm>
+#include <atomic>
 #include <memory>
+#include <utility>
 
 namespace aligned {
 
@@ -31,25 +36,70 @@ public:
     using reference_type = T&;
     using const_reference_type = const T&;
 
-    explicit aligned_mem(std::size_t alignment, std::size_t count) :
-      m_data(static_cast<value_type*>(std::aligned_alloc(alignment, count * sizeof(value_type)))),
+    explicit aligned_mem(std::size_t alignment, std::size_t count, pool& from = pool::global()) :
+      m_data(static_cast<value_type*>(from.acquire(count * sizeof(value_type), alignment))),
+      m_pool(&from),
       m_alignment(alignment),
       m_count(count) {}
     
     ~aligned_mem() {
-        std::free(m_data);
+        if (m_data != nullptr) {
+            m_pool->release(m_data, size_bytes(), m_alignment);
+        }
     }
 
-    aligned_mem(const aligned_mem<T>& other) : 
-      m_data(static_cast<value_type*>(std::aligned_alloc(other.m_alignment, other.size_bytes()))),
+    aligned_mem(const aligned_mem<T>& other) :
+      aligned_mem(other, *other.m_pool) {}
+
+    // Copy whose storage comes from another pool (another memory policy)
+    aligned_mem(const aligned_mem<T>& other, pool& from) :
+      m_data(static_cast<value_type*>(from.acquire(other.size_bytes(), other.m_alignment))),
+      m_pool(&from),
       m_alignment(other.m_alignment),
-      m_count(other.m_count) {
+      m_count(other.m_count),
+      m_context(other.m_context),
+      m_valid(other.m_valid) {
         std::copy(other.m_data, other.m_data + size(), m_data);
     }
 
+    // Moves hand over the storage; the moved-from object is left empty
+    aligned_mem(aligned_mem<T>&& other) noexcept :
+      m_data(std::exchange(other.m_data, nullptr)),
+      m_pool(other.m_pool),
+      m_alignment(other.m_alignment),
+      m_count(std::exchange(other.m_count, 0)),
+      m_context(std::move(other.m_context)),
+      m_valid(other.m_valid) {}
+
     aligned_mem<T>& operator=(const aligned_mem<T>&) = delete;
-    aligned_mem(aligned_mem<T>&&) = delete;
-    aligned_mem<T>& operator=(aligned_mem<T>&&) = delete;
+
+    aligned_mem<T>& operator=(aligned_mem<T>&& other) noexcept {
+        if (this != &other) {
+            if (m_data != nullptr) {
+                m_pool->release(m_data, size_bytes(), m_alignment);
+            }
+            m_data = std::exchange(other.m_data, nullptr);
+            m_pool = other.m_pool;
+            m_alignment = other.m_alignment;
+            m_count = std::exchange(other.m_count, 0);
+            m_context = std::move(other.m_context);
+            m_valid = other.m_valid;
+        }
+        return *this;
+    }
+
+    // The objects themselves are recycled too, so a frame costs no heap traffic
+    static auto operator new(std::size_t bytes) -> void* {
+        auto* block = pool::global().acquire(bytes, alignof(aligned_mem<T>));
+        if (block == nullptr) {
+            throw std::bad_alloc();
+        }
+        return block;
+    }
+
+    static auto operator delete(void* block, std::size_t bytes) -> void {
+        pool::global().release(block, bytes, alignof(aligned_mem<T>));
+    }
 
     auto data() -> T* {
         return m_data;
@@ -85,16 +135,67 @@ public:
         return size() * sizeof(value_type);
     }
 
+    // Context of the stream the samples came from, if known
+    auto context() const -> const metadata::context_ptr& {
+        return m_context;
+    }
+
+    auto set_context(metadata::context_ptr context) -> void {
+        m_context = std::move(context);
+    }
+
+    // False when the samples are known not to be contiguous (e.g. lost packets)
+    auto valid() const -> bool {
+        return m_valid;
+    }
+
+    auto set_valid(bool valid) -> void {
+        m_valid = valid;
+    }
+
 private:
     value_type* m_data{nullptr};
+    pool* m_pool{nullptr};
     std::size_t m_alignment{};
     std::size_t m_count{};
+    metadata::context_ptr m_context;
+    bool m_valid{true};
 
 }; // class aligned_mem
 
 template <typename T>
-auto make_aligned(std::size_t alignment, std::size_t count) -> std::unique_ptr<aligned_mem<T>> {
-    return std::make_unique<aligned_mem<T>>(alignment, count);
+auto make_aligned(std::size_t alignment, std::size_t count, pool& from = pool::global()) -> std::unique_ptr<aligned_mem<T>> {
+    return std::make_unique<aligned_mem<T>>(alignment, count, from);
+}
+
+/*
+ * Frame type carried between components. It is immutable once sent, so an
+ * output can be handed to any number of consumers without copying; a
+ * consumer that processes in place goes through writable().
+ */
+template <typename T>
+using shared_mem = std::shared_ptr<const aligned_mem<T>>;
+
+/*
+ * Copy-on-write access to a shared frame: the frame itself when this is its
+ * only reference, otherwise a private copy that replaces it in frame. The
+ * copy comes from the frame's own pool unless the caller names another.
+ */
+template <typename T>
+auto writable(shared_mem<T>& frame, pool* into = nullptr) -> aligned_mem<T>* {
+    if (frame == nullptr) {
+        return nullptr;
+    }
+    if (frame.use_count() == 1) {
+        // Order our writes after the reads of the owners that let go of it
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return const_cast<aligned_mem<T>*>(frame.get());
+    }
+    auto copy = into != nullptr ?
+        std::shared_ptr<aligned_mem<T>>(new aligned_mem<T>(*frame, *into)) :
+        std::shared_ptr<aligned_mem<T>>(new aligned_mem<T>(*frame));
+    frame = copy;
+    return copy.get();
 }
 
 } // namespace aligned
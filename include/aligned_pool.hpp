@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <alloc_policy.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace aligned {
+
+/*
+ * Process-wide cache of 64 byte aligned blocks in power-of-two size classes,
+ * so buffers freed by one component are handed straight back to the next
+ * allocation of the same class instead of going through the heap. Each class
+ * keeps at most max_cached() blocks and the whole cache at most max_bytes();
+ * beyond that blocks are freed. Larger alignments bypass the cache.
+ *
+ * There is one pool per allocation policy (get()), global() being the
+ * default one. Blocks keep their pages and NUMA binding while cached, so a
+ * recycled huge page buffer costs no page faults.
+ *
+ * The pools are inline function statics, which GCC makes unique across the
+ * component libraries, so all components share them. They are never
+ * destroyed, as buffers may be released during static destruction.
+ */
+class pool {
+public:
+    static constexpr std::size_t ALIGNMENT = 64;
+    static constexpr std::size_t MIN_CLASS = 6; // 64 bytes
+    static constexpr std::size_t NUM_CLASSES = 40;
+    static constexpr std::size_t MAX_CACHED = 64;
+    static constexpr std::size_t MAX_BYTES = std::size_t{1} << 30;
+
+    static auto global() -> pool& {
+        static auto* instance = new pool(alloc_policy{});
+        return *instance;
+    }
+
+    static auto get(const alloc_policy& policy) -> pool& {
+        if (policy == alloc_policy{}) {
+            return global();
+        }
+        static auto* lock = new std::mutex();
+        static auto* pools = new std::vector<pool*>();
+        auto guard = std::lock_guard(*lock);
+        auto found = std::find_if(pools->begin(), pools->end(), [&policy](const pool* candidate) {
+            return candidate->policy() == policy;
+        });
+        if (found != pools->end()) {
+            return **found;
+        }
+        return *pools->emplace_back(new pool(policy));
+    }
+
+    auto policy() const -> const alloc_policy& {
+        return m_policy;
+    }
+
+    auto acquire(std::size_t bytes, std::size_t alignment) -> void* {
+        if (alignment > ALIGNMENT) {
+            return pages::allocate(bytes, alignment, m_policy);
+        }
+        auto cls = size_class(bytes);
+        auto& list = m_classes[cls];
+        {
+            auto lock = std::lock_guard(list.lock);
+            if (!list.blocks.empty()) {
+                auto* block = list.blocks.back();
+                list.blocks.pop_back();
+                m_cached_bytes -= class_bytes(cls);
+                m_hits.fetch_add(1, std::memory_order_relaxed);
+                return block;
+            }
+        }
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return pages::allocate(class_bytes(cls), ALIGNMENT, m_policy);
+    }
+
+    auto release(void* block, std::size_t bytes, std::size_t alignment) -> void {
+        if (block == nullptr) {
+            return;
+        }
+        if (alignment > ALIGNMENT) {
+            pages::release(block, bytes, alignment, m_policy);
+            return;
+        }
+        auto cls = size_class(bytes);
+        auto& list = m_classes[cls];
+        {
+            auto lock = std::lock_guard(list.lock);
+            if (list.blocks.size() < m_max_cached && m_cached_bytes + class_bytes(cls) <= m_max_bytes) {
+                if (list.blocks.capacity() == 0) {
+                    list.blocks.reserve(m_max_cached);
+                }
+                list.blocks.push_back(block);
+                m_cached_bytes += class_bytes(cls);
+                return;
+            }
+        }
+        pages::release(block, class_bytes(cls), ALIGNMENT, m_policy);
+    }
+
+    // Bounds on what is kept for reuse; takes effect as blocks are released
+    auto set_limits(std::size_t max_cached, std::size_t max_bytes) -> void {
+        m_max_cached = max_cached;
+        m_max_bytes = max_bytes;
+    }
+
+    auto max_cached() const -> std::size_t {
+        return m_max_cached;
+    }
+
+    auto max_bytes() const -> std::size_t {
+        return m_max_bytes;
+    }
+
+    auto cached_bytes() const -> std::size_t {
+        return m_cached_bytes;
+    }
+
+    // Allocations served from the cache and from the heap
+    auto hits() const -> uint64_t {
+        return m_hits.load(std::memory_order_relaxed);
+    }
+
+    auto misses() const -> uint64_t {
+        return m_misses.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct block_list {
+        std::mutex lock;
+        std::vector<void*> blocks;
+    };
+
+    alloc_policy m_policy;
+    std::array<block_list, NUM_CLASSES> m_classes;
+    std::atomic<std::size_t> m_max_cached{MAX_CACHED};
+    std::atomic<std::size_t> m_max_bytes{MAX_BYTES};
+    std::atomic<std::size_t> m_cached_bytes{};
+    std::atomic<uint64_t> m_hits{};
+    std::atomic<uint64_t> m_misses{};
+
+    explicit pool(const alloc_policy& policy) :
+      m_policy(policy) {}
+
+    static auto size_class(std::size_t bytes) -> std::size_t {
+        auto width = std::bit_width(std::max<std::size_t>(bytes, 1) - 1);
+        return width > MIN_CLASS ? width - MIN_CLASS : 0;
+    }
+
+    static auto class_bytes(std::size_t cls) -> std::size_t {
+        return std::size_t{1} << (cls + MIN_CLASS);
+    }
+
+}; // class pool
+
+// Standard allocator drawing from the global pool, for containers passed between components
+template <typename T>
+struct pool_allocator {
+    using value_type = T;
+
+    pool_allocator() = default;
+
+    template <typename U>
+    pool_allocator(const pool_allocator<U>&) {}
+
+    auto allocate(std::size_t count) -> T* {
+        auto* block = pool::global().acquire(count * sizeof(T), alignof(T));
+        if (block == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(block);
+    }
+
+    auto deallocate(T* block, std::size_t count) -> void {
+        pool::global().release(block, count * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    auto operator==(const pool_allocator<U>&) const -> bool {
+        return true;
+    }
+};
+
+} // namespace aligned
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <aligned_mem.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+
+namespace aligned {
+
+/*
+ * Read-only window of offset/count elements into an aligned_mem, sharing
+ * ownership of it so the parent's storage stays alive for as long as any
+ * view does. Slicing a frame this way, e.g. picking one band out of an fft
+ * output, hands the samples downstream without allocating or copying.
+ */
+template <typename T>
+class aligned_view {
+public:
+    using value_type = T;
+    using parent_t = aligned_mem<T>;
+    using const_reference_type = const T&;
+
+    aligned_view() = default;
+
+    // The whole of parent
+    explicit aligned_view(shared_mem<T> parent) :
+      m_parent(std::move(parent)),
+      m_count(m_parent != nullptr ? m_parent->size() : 0) {}
+
+    aligned_view(shared_mem<T> parent, std::size_t offset, std::size_t count) :
+      m_parent(std::move(parent)),
+      m_offset(offset),
+      m_count(count) {
+        if (m_parent == nullptr || offset > m_parent->size() || count > m_parent->size() - offset) {
+            throw std::out_of_range("aligned_view: range outside of parent");
+        }
+    }
+
+    // Narrow further; offset is relative to this view
+    auto subview(std::size_t offset, std::size_t count) const -> aligned_view<T> {
+        if (offset > m_count || count > m_count - offset) {
+            throw std::out_of_range("aligned_view: range outside of view");
+        }
+        return aligned_view<T>(m_parent, m_offset + offset, count);
+    }
+
+    auto data() const -> const T* {
+        return m_parent != nullptr ? m_parent->data() + m_offset : nullptr;
+    }
+
+    auto at(std::size_t pos) const -> const_reference_type {
+        if (pos >= size()) {
+            throw std::out_of_range("aligned_view: index out of range");
+        }
+        return *(data() + pos);
+    }
+
+    auto span() const -> std::span<const T> {
+        return {data(), m_count};
+    }
+
+    // Alignment the view's start actually has, at most the parent's
+    auto alignment() const -> std::size_t {
+        if (m_parent == nullptr) {
+            return 0;
+        }
+        auto offset_bytes = m_offset * sizeof(value_type);
+        if (offset_bytes == 0) {
+            return m_parent->alignment();
+        }
+        return std::min(m_parent->alignment(), std::size_t{1} << std::countr_zero(offset_bytes));
+    }
+
+    auto offset() const -> std::size_t {
+        return m_offset;
+    }
+
+    auto size() const -> std::size_t {
+        return m_count;
+    }
+
+    auto size_bytes() const -> std::size_t {
+        return size() * sizeof(value_type);
+    }
+
+    auto parent() const -> const shared_mem<T>& {
+        return m_parent;
+    }
+
+    auto context() const -> const metadata::context_ptr& {
+        static const auto none = metadata::context_ptr{};
+        return m_parent != nullptr ? m_parent->context() : none;
+    }
+
+    auto valid() const -> bool {
+        return m_parent == nullptr || m_parent->valid();
+    }
+
+private:
+    shared_mem<T> m_parent;
+    std::size_t m_offset{};
+    std::size_t m_count{};
+
+}; // class aligned_view
+
+template <typename T>
+auto make_view(shared_mem<T> parent, std::size_t offset, std::size_t count) -> aligned_view<T> {
+    return aligned_view<T>(std::move(parent), offset, count);
+}
+
+} // namespace aligned
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <linux/mempolicy.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace aligned {
+
+enum class page_policy : uint8_t {
+    DEFAULT,            // heap, 4 KiB pages
+    TRANSPARENT_HUGE,   // 2 MiB aligned heap blocks advised MADV_HUGEPAGE
+    HUGETLB             // MAP_HUGETLB for blocks of 2 MiB and up, falling back to advised anonymous mappings;
+                        // smaller blocks come from the heap as with TRANSPARENT_HUGE
+};
+
+/*
+ * Where the pages of a buffer come from. numa_node >= 0 binds them to that
+ * node (mbind); first_touch faults them in when first allocated, on the
+ * allocating thread's node unless bound, instead of in the processing loop.
+ */
+struct alloc_policy {
+    page_policy pages{page_policy::DEFAULT};
+    int numa_node{-1};
+    bool first_touch{false};
+
+    auto operator==(const alloc_policy&) const -> bool = default;
+};
+
+// memory: default|thp|hugetlb, numa_node: "" (none), "local" (first touch) or a node number
+inline auto parse_alloc_policy(std::string_view memory, const std::string& numa_node) -> std::optional<alloc_policy> {
+    auto policy = alloc_policy{};
+    if (memory == "thp") {
+        policy.pages = page_policy::TRANSPARENT_HUGE;
+    } else if (memory == "hugetlb") {
+        policy.pages = page_policy::HUGETLB;
+    } else if (!memory.empty() && memory != "default") {
+        return {};
+    }
+    if (numa_node == "local") {
+        policy.first_touch = true;
+    } else if (!numa_node.empty()) {
+        auto [end, ec] = std::from_chars(numa_node.data(), numa_node.data() + numa_node.size(), policy.numa_node);
+        if (ec != std::errc{} || end != numa_node.data() + numa_node.size() || policy.numa_node < 0) {
+            return {};
+        }
+        policy.first_touch = true;
+    }
+    return policy;
+}
+
+namespace pages {
+
+constexpr std::size_t PAGE_SIZE = 4096;
+constexpr std::size_t HUGE_PAGE_SIZE = std::size_t{2} << 20;
+constexpr int MAX_NODES = 1024;
+
+inline auto round_up(std::size_t bytes, std::size_t alignment) -> std::size_t {
+    return (std::max<std::size_t>(bytes, 1) + alignment - 1) / alignment * alignment;
+}
+
+// Bytes actually reserved for a block of the given size under a policy
+inline auto reserved(std::size_t bytes, std::size_t alignment, const alloc_policy& policy) -> std::size_t {
+    switch (policy.pages) {
+        case page_policy::DEFAULT:
+            return round_up(bytes, policy.numa_node >= 0 ? std::max(alignment, PAGE_SIZE) : alignment);
+        case page_policy::TRANSPARENT_HUGE:
+        case page_policy::HUGETLB:
+            return round_up(bytes, bytes >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : std::max(alignment, PAGE_SIZE));
+    }
+    return bytes;
+}
+
+// Anonymous mapping of length bytes starting on an alignment boundary (a power of two)
+inline auto map_aligned(std::size_t length, std::size_t alignment, int flags) -> void* {
+    auto* mapped = mmap(nullptr, length + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+    // Trim what lies outside the aligned block
+    auto start = reinterpret_cast<uintptr_t>(mapped);
+    auto aligned = (start + alignment - 1) & ~(uintptr_t{alignment} - 1);
+    if (aligned > start) {
+        munmap(mapped, aligned - start);
+    }
+    munmap(reinterpret_cast<void*>(aligned + length), start + alignment - aligned);
+    return reinterpret_cast<void*>(aligned);
+}
+
+inline auto bind(void* block, std::size_t length, int node) -> void {
+    if (node < 0 || node >= MAX_NODES) {
+        return;
+    }
+    unsigned long mask[MAX_NODES / (8 * sizeof(unsigned long))]{};
+    mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+    // Best effort: without the node (or permission) the pages stay where they are
+    syscall(SYS_mbind, block, length, MPOL_BIND, mask, MAX_NODES, MPOL_MF_MOVE);
+}
+
+inline auto allocate(std::size_t bytes, std::size_t alignment, const alloc_policy& policy) -> void* {
+    auto length = reserved(bytes, alignment, policy);
+    void* block = nullptr;
+    switch (policy.pages) {
+        case page_policy::DEFAULT:
+            block = std::aligned_alloc(policy.numa_node >= 0 ? std::max(alignment, PAGE_SIZE) : alignment, length);
+            break;
+        case page_policy::TRANSPARENT_HUGE:
+            block = std::aligned_alloc(length >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : std::max(alignment, PAGE_SIZE), length);
+            if (block != nullptr && length >= HUGE_PAGE_SIZE) {
+                madvise(block, length, MADV_HUGEPAGE);
+            }
+            break;
+        case page_policy::HUGETLB:
+            // Blocks under a huge page would waste most of it, so they get
+            // normal pages from the heap, aligned like any other block
+            if (length < HUGE_PAGE_SIZE) {
+                block = std::aligned_alloc(std::max(alignment, PAGE_SIZE), length);
+                break;
+            }
+            // Huge page mappings start on a huge page, which covers any
+            // alignment up to that; a larger one goes to the fallback
+            if (alignment <= HUGE_PAGE_SIZE) {
+                block = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                block = block == MAP_FAILED ? nullptr : block;
+            }
+            if (block == nullptr) {
+                // No reserved huge pages: fall back to transparent ones
+                block = map_aligned(length, std::max(alignment, HUGE_PAGE_SIZE), 0);
+                if (block != nullptr) {
+                    madvise(block, length, MADV_HUGEPAGE);
+                }
+            }
+            break;
+    }
+    if (block == nullptr) {
+        return nullptr;
+    }
+    bind(block, length, policy.numa_node);
+    if (policy.first_touch) {
+        std::memset(block, 0, length);
+    }
+    return block;
+}
+
+inline auto release(void* block, std::size_t bytes, std::size_t alignment, const alloc_policy& policy) -> void {
+    if (auto length = reserved(bytes, alignment, policy); policy.pages == page_policy::HUGETLB && length >= HUGE_PAGE_SIZE) {
+        munmap(block, length);
+    } else {
+        std::free(block);
+    }
+}
+
+} // namespace pages
+
+} // namespace aligned
@@ -17,8 +17,19 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 
-#include <map>
+#pragma once
+
+#include <packet_batch.hpp>
+#include <sequence.hpp>
+#include <stream_context.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
 #include <span>
+#include <string_view>
+#include <vector>
 #include <vrtgen/vrtgen.hpp>
 
 namespace overlay {
@@ -37,6 +48,11 @@ public:
       m_data(data) {
     }
 
+    // 16 bit frame sequence number
+    auto seq() const -> uint16_t {
+        return vrtgen::swap::from_be(*reinterpret_cast<const uint16_t*>(m_data.data() + 2));
+    }
+
     auto ttag() const -> uint64_t {
         return vrtgen::swap::from_be(*reinterpret_cast<const uint64_t*>(m_data.data() + 8));
     }
@@ -78,92 +94,206 @@ auto is_context(const vrtgen::packing::Header& header) -> bool {
     return (header.packet_type() == CONTEXT);
 }
 
-class overlay {
+/*
+ * Byte offsets of the fields a VRT header announces. They depend only on the
+ * header word less its packet count and size, so one layout serves every
+ * packet of a stream whose header does not change.
+ */
+class layout {
+    static constexpr uint32_t VARYING_MASK = 0x000FFFFF; // packet count, packet size
 public:
-    explicit overlay(std::span<const uint8_t> data) :
-      m_data(data) {
-        m_header.unpack_from(m_data.data());
-        auto curr_idx = m_header.size();
-        if (m_header.packet_type() != vrtgen::packing::PacketType::SIGNAL_DATA) {
-            m_positions["stream_id"] = curr_idx;
+    static constexpr uint8_t ABSENT = 0; // the header itself sits at offset 0
+
+    layout() = default;
+
+    explicit layout(const uint8_t* data) :
+      m_word(header_word(data) & ~VARYING_MASK),
+      m_valid(true) {
+        auto header = vrtgen::packing::Header{};
+        header.unpack_from(data);
+        m_data = v49::is_data(header);
+        m_context = v49::is_context(header);
+        auto curr_idx = static_cast<uint8_t>(header.size());
+        if (header.packet_type() != vrtgen::packing::PacketType::SIGNAL_DATA) {
+            m_stream_id = curr_idx;
             curr_idx += sizeof(uint32_t); // stream_id
         }
-        if (m_header.class_id_enable()) {
-            m_positions["class_id"] = curr_idx;
+        if (header.class_id_enable()) {
+            m_class_id = curr_idx;
             curr_idx += 8; // bytes, class_id
         }
-        if (m_header.tsi() != vrtgen::packing::TSI::NONE) {
-            m_positions["integer_timestamp"] = curr_idx;
+        if (header.tsi() != vrtgen::packing::TSI::NONE) {
+            m_integer_timestamp = curr_idx;
             curr_idx += sizeof(uint32_t); // integer_timestamp
         }
-        if (m_header.tsf() != vrtgen::packing::TSF::NONE) {
-            m_positions["fractional_timestamp"] = curr_idx;
+        if (header.tsf() != vrtgen::packing::TSF::NONE) {
+            m_fractional_timestamp = curr_idx;
             curr_idx += sizeof(uint64_t); // fractional_timestamp
         }
-        if (is_data(m_header)) {
-            m_positions["payload"] = curr_idx;
+        m_prologue = curr_idx;
+        if (m_data || m_context) {
+            m_payload = curr_idx;
+        }
+        if (m_data) {
             auto data_header = vrtgen::packing::DataHeader{};
-            data_header.unpack_from(m_data.data());
-            if (data_header.trailer_included()) {
-                m_positions["trailer"] = (m_header.packet_size() - 1) * sizeof(uint32_t)/*word size*/;
+            data_header.unpack_from(data);
+            m_trailer = data_header.trailer_included();
+        }
+    }
+
+    static auto header_word(const uint8_t* data) -> uint32_t {
+        return vrtgen::swap::from_be(*reinterpret_cast<const uint32_t*>(data));
+    }
+
+    // Whether a packet with this header word shares the layout
+    auto matches(uint32_t word) const -> bool {
+        return m_valid && ((word & ~VARYING_MASK) == m_word);
+    }
+
+    auto is_data() const -> bool { return m_data; }
+    auto is_context() const -> bool { return m_context; }
+    auto trailer() const -> bool { return m_trailer; }
+    auto stream_id() const -> uint8_t { return m_stream_id; }
+    auto class_id() const -> uint8_t { return m_class_id; }
+    auto integer_timestamp() const -> uint8_t { return m_integer_timestamp; }
+    auto fractional_timestamp() const -> uint8_t { return m_fractional_timestamp; }
+    auto payload() const -> uint8_t { return m_payload; }
+    // Bytes of header and optional fields before the payload
+    auto prologue() const -> uint8_t { return m_prologue; }
+
+private:
+    uint32_t m_word{};
+    bool m_valid{false};
+    bool m_data{false};
+    bool m_context{false};
+    bool m_trailer{false};
+    uint8_t m_stream_id{ABSENT};
+    uint8_t m_class_id{ABSENT};
+    uint8_t m_integer_timestamp{ABSENT};
+    uint8_t m_fractional_timestamp{ABSENT};
+    uint8_t m_payload{ABSENT};
+    uint8_t m_prologue{};
+
+}; // class layout
+
+/*
+ * The few most recent layouts, so interleaved streams with different headers
+ * still hit. A hit costs one masked compare of the header word per entry.
+ */
+class layout_cache {
+    static constexpr std::size_t NUM_LAYOUTS = 4;
+public:
+    auto get(const uint8_t* data) -> const layout& {
+        auto word = layout::header_word(data);
+        for (const auto& entry : m_layouts) {
+            if (entry.matches(word)) {
+                return entry;
             }
         }
+        auto& entry = m_layouts[m_next];
+        entry = layout(data);
+        m_next = (m_next + 1) % NUM_LAYOUTS;
+        return entry;
     }
 
-    auto header() const -> const vrtgen::packing::Header& {
-        return m_header;
+private:
+    std::array<layout, NUM_LAYOUTS> m_layouts;
+    std::size_t m_next{};
+
+}; // class layout_cache
+
+class overlay {
+public:
+    explicit overlay(std::span<const uint8_t> data) :
+      m_data(data),
+      m_layout(data.data()),
+      m_word(layout::header_word(data.data())) {
+    }
+
+    // Reuses the layout of an earlier packet with the same header
+    overlay(std::span<const uint8_t> data, layout_cache& cache) :
+      m_data(data),
+      m_layout(cache.get(data.data())),
+      m_word(layout::header_word(data.data())) {
+    }
+
+    auto header() const -> vrtgen::packing::Header {
+        auto header = vrtgen::packing::Header{};
+        header.unpack_from(m_data.data());
+        return header;
+    }
+
+    auto is_data() const -> bool {
+        return m_layout.is_data();
+    }
+
+    auto is_context() const -> bool {
+        return m_layout.is_context();
+    }
+
+    // 4 bit per-stream packet count from the header
+    auto packet_count() const -> uint8_t {
+        return static_cast<uint8_t>((m_word >> 16) & 0x0F);
+    }
+
+    // Packet size in 32 bit words
+    auto packet_size() const -> uint16_t {
+        return static_cast<uint16_t>(m_word & 0xFFFF);
     }
 
     auto stream_id() const -> std::optional<uint32_t> {
-        if (!m_positions.contains("stream_id")) {
+        if (m_layout.stream_id() == layout::ABSENT) {
             return {};
         }
-        auto pos = m_positions.at("stream_id");
-        return vrtgen::swap::from_be(*reinterpret_cast<const uint32_t*>(m_data.data() + pos));
+        return vrtgen::swap::from_be(*reinterpret_cast<const uint32_t*>(m_data.data() + m_layout.stream_id()));
     }
 
     auto class_id() const -> std::optional<vrtgen::packing::ClassIdentifier> {
-        if (!m_positions.contains("class_id")) {
+        if (m_layout.class_id() == layout::ABSENT) {
             return {};
         }
-        auto pos = m_positions.at("class_id");
         auto class_id = vrtgen::packing::ClassIdentifier{};
-        class_id.unpack_from(m_data.data() + pos);
+        class_id.unpack_from(m_data.data() + m_layout.class_id());
         return class_id;
     }
 
     auto integer_timestamp() const -> std::optional<uint32_t> {
-        if (!m_positions.contains("integer_timestamp")) {
+        if (m_layout.integer_timestamp() == layout::ABSENT) {
             return {};
         }
-        auto pos = m_positions.at("integer_timestamp");
-        return vrtgen::swap::from_be(*reinterpret_cast<const uint32_t*>(m_data.data() + pos));
+        return vrtgen::swap::from_be(*reinterpret_cast<const uint32_t*>(m_data.data() + m_layout.integer_timestamp()));
     }
 
     auto fractional_timestamp() const -> std::optional<uint64_t> {
-        if (!m_positions.contains("fractional_timestamp")) {
+        if (m_layout.fractional_timestamp() == layout::ABSENT) {
             return {};
         }
-        auto pos = m_positions.at("fractional_timestamp");
-        return vrtgen::swap::from_be(*reinterpret_cast<const uint64_t*>(m_data.data() + pos));
+        return vrtgen::swap::from_be(*reinterpret_cast<const uint64_t*>(m_data.data() + m_layout.fractional_timestamp()));
+    }
+
+    // Whether the packet the header claims, with every field it announces,
+    // lies within the datagram; the other accessors assume it does
+    auto complete() const -> bool {
+        auto claimed = std::size_t{packet_size()} * sizeof(uint32_t);
+        auto minimum = m_layout.prologue() + (m_layout.trailer() ? sizeof(uint32_t) : 0);
+        return claimed >= minimum && claimed <= m_data.size();
     }
 
     template<typename T>
     auto payload() const -> std::span<const T> {
-        if (!m_positions.contains("payload")) {
+        if (m_layout.payload() == layout::ABSENT) {
             return {};
         }
-        auto pos = m_positions.at("payload");
-        auto data = reinterpret_cast<const T*>(m_data.data() + pos);
+        auto data = reinterpret_cast<const T*>(m_data.data() + m_layout.payload());
         return std::span<const T>(data, payload_size() / sizeof(T));
     }
 
     auto payload_size() const -> size_t {
-        if (!m_positions.contains("payload")) {
+        if (m_layout.payload() == layout::ABSENT) {
             return {};
         }
-        auto size = (m_header.packet_size() * sizeof(uint32_t)/*word size*/) - m_positions.at("payload");
-        if (m_positions.contains("trailer")) {
+        auto size = (packet_size() * sizeof(uint32_t)/*word size*/) - m_layout.payload();
+        if (m_layout.trailer()) {
             size -= sizeof(uint32_t);
         }
         return size;
@@ -171,10 +301,314 @@ public:
 
 private:
     std::span<const uint8_t> m_data;
-    vrtgen::packing::Header m_header;
-    std::map<std::string, std::size_t> m_positions;
+    layout m_layout;
+    uint32_t m_word;
 
 }; // class overlay
 
+/*
+ * Context packet fields (VITA 49.2 CIF0). The payload starts with the CIF0
+ * word, followed by any CIF1/2/3/7 words it enables, then the enabled fields
+ * from bit 30 down. Only the fields up to sample rate are walked. The
+ * walk is by hand because vrtgen's packing classes decode the fixed field
+ * set of a generated packet class, while a receiver has to follow whatever
+ * fields the sender enables.
+ */
+namespace cif0 {
+
+static constexpr unsigned BANDWIDTH = 29;
+static constexpr unsigned RF_REFERENCE_FREQUENCY = 27;
+static constexpr unsigned REFERENCE_LEVEL = 24;
+static constexpr unsigned SAMPLE_RATE = 21;
+static constexpr std::array<unsigned, 4> EXTENSION_WORDS{1, 2, 3, 7}; // CIF1, CIF2, CIF3, CIF7
+// Field size in words for bits 30 (reference point ID) down to 21 (sample rate)
+static constexpr std::array<uint8_t, 10> FIELD_WORDS{1, 2, 2, 2, 2, 2, 1, 1, 1, 2};
+
+} // namespace cif0
+
+// Merges the fields a context packet carries into the stream's context
+inline auto parse_context(std::span<const uint8_t> payload, metadata::stream_context& context) -> void {
+    if (payload.size() < sizeof(uint32_t)) {
+        return;
+    }
+    auto word = [&payload](std::size_t offset) {
+        return vrtgen::swap::from_be(*reinterpret_cast<const uint32_t*>(payload.data() + offset));
+    };
+    // 64 bit, radix point at bit 20
+    auto q44_20 = [&](std::size_t offset) {
+        auto value = (static_cast<uint64_t>(word(offset)) << 32) | word(offset + sizeof(uint32_t));
+        return static_cast<double>(static_cast<int64_t>(value)) / double(1 << 20);
+    };
+    auto enables = word(0);
+    auto offset = sizeof(uint32_t);
+    for (auto bit : cif0::EXTENSION_WORDS) {
+        if (enables & (1u << bit)) {
+            offset += sizeof(uint32_t);
+        }
+    }
+    for (auto bit = 30u; bit >= cif0::SAMPLE_RATE; --bit) {
+        if (!(enables & (1u << bit))) {
+            continue;
+        }
+        auto size = cif0::FIELD_WORDS[30 - bit] * sizeof(uint32_t);
+        if (offset + size > payload.size()) {
+            return;
+        }
+        switch (bit) {
+            case cif0::BANDWIDTH:
+                context.bandwidth = q44_20(offset);
+                break;
+            case cif0::RF_REFERENCE_FREQUENCY:
+                context.rf_reference_frequency = q44_20(offset);
+                break;
+            case cif0::REFERENCE_LEVEL:
+                // Low 16 bits, radix point at bit 7
+                context.reference_level = static_cast<int16_t>(word(offset) & 0xFFFF) / 128.0;
+                break;
+            case cif0::SAMPLE_RATE:
+                context.sample_rate = q44_20(offset);
+                break;
+            default:
+                break;
+        }
+        offset += size;
+    }
+}
+
 } // namespace v49
+
+enum class transport {
+    SDDS,
+    VITA49,
+    RAW
+};
+
+inline auto parse_transport(std::string_view name) -> std::optional<transport> {
+    if (name == "sdds") {
+        return transport::SDDS;
+    }
+    if (name == "vita49") {
+        return transport::VITA49;
+    }
+    if (name == "raw") {
+        return transport::RAW;
+    }
+    return {};
+}
+
+/*
+ * Framings the descriptor table is specialized on, one tag per transport.
+ * Adding a transport means adding a tag here, a parse_datagram overload and
+ * a case in parser().
+ */
+namespace framing {
+
+// Frame sequence numbers with seq % 32 == 31 reserved for parity frames,
+// which data frames skip whether or not the sender emits parity
+struct sdds {
+    static constexpr unsigned SEQUENCE_BITS = 16;
+    static constexpr uint32_t PARITY_PERIOD = 32;
+};
+
+// Header, trailer and CIF0 handling follow the packet's own header word
+struct vita49 {
+    static constexpr unsigned SEQUENCE_BITS = 4;
+    static constexpr uint32_t PARITY_PERIOD = 0;
+};
+
+// Bare sample payload, no header; stamped with the receive time
+struct raw {
+    static constexpr unsigned SEQUENCE_BITS = 0;
+    static constexpr uint32_t PARITY_PERIOD = 0;
+};
+
+template<typename Framing>
+constexpr auto numbering() -> sequence::numbering {
+    return {Framing::SEQUENCE_BITS, Framing::PARITY_PERIOD};
+}
+
+} // namespace framing
+
+// Per-stream sequence numbering a transport carries (bits = 0: none)
+inline auto sequence_numbering(transport kind) -> sequence::numbering {
+    switch (kind) {
+        case transport::SDDS:
+            return framing::numbering<framing::sdds>();
+        case transport::VITA49:
+            return framing::numbering<framing::vita49>();
+        case transport::RAW:
+            return framing::numbering<framing::raw>();
+    }
+    return {0, 0};
+}
+
+enum class packet_kind : uint8_t {
+    DATA,
+    CONTEXT,
+    OTHER  // other VRT packet types and datagrams shorter than their header claims
+};
+
+/*
+ * Struct-of-arrays descriptors of one packet batch, decoded in a single pass
+ * so consumers walk contiguous fields instead of re-decoding every header.
+ * SDDS packets are data on stream 0 with the frame sequence number, except
+ * parity frames (framing::sdds), which are OTHER;
+ * VITA-49 packets carry their stream ID (0 if absent) and 4 bit packet count;
+ * the payload of a context packet starts at its CIF0 word (v49::parse_context).
+ * Raw datagrams are data on stream 0, all payload, with no sequence number.
+ * Timestamps are the integer and fractional fields as found in the packet,
+ * or the receive time (seconds, picoseconds) for raw datagrams.
+ *
+ * parse() is instantiated per framing so the per-datagram loop has no
+ * transport branch; parser() picks the instantiation. Consumers normally go
+ * through descriptors(), which keeps one table per batch for all of them.
+ */
+class descriptor_table {
+public:
+    using parse_fn = void (descriptor_table::*)(const batch::packet_batch&);
+
+    template<typename Framing>
+    auto parse(const batch::packet_batch& batch) -> void {
+        clear(batch.data());
+        reserve(batch.size());
+        for (auto idx = size_t{}; idx < batch.size(); ++idx) {
+            parse_datagram(Framing{}, batch[idx], batch.timestamp(idx));
+        }
+    }
+
+    static auto parser(transport kind) -> parse_fn {
+        switch (kind) {
+            case transport::SDDS:
+                return &descriptor_table::parse<framing::sdds>;
+            case transport::VITA49:
+                return &descriptor_table::parse<framing::vita49>;
+            case transport::RAW:
+                return &descriptor_table::parse<framing::raw>;
+        }
+        return nullptr;
+    }
+
+    auto size() const -> std::size_t {
+        return m_kind.size();
+    }
+
+    template<typename T>
+    auto payload(std::size_t idx) const -> std::span<const T> {
+        auto data = reinterpret_cast<const T*>(m_base + m_payload_offset[idx]);
+        return std::span<const T>(data, m_payload_length[idx] / sizeof(T));
+    }
+
+    // Per-field columns, indexed like the batch
+    auto payload_offsets() const -> std::span<const uint32_t> { return m_payload_offset; }
+    auto payload_lengths() const -> std::span<const uint32_t> { return m_payload_length; }
+    auto seconds() const -> std::span<const uint32_t> { return m_seconds; }
+    auto picoseconds() const -> std::span<const uint64_t> { return m_picoseconds; }
+    auto stream_ids() const -> std::span<const uint32_t> { return m_stream_id; }
+    auto sequences() const -> std::span<const uint16_t> { return m_sequence; }
+    auto kinds() const -> std::span<const packet_kind> { return m_kind; }
+
+private:
+    static constexpr std::size_t SDDS_MIN_LEN = 56 + 1024;
+    static constexpr std::size_t VITA49_MIN_LEN = 4;
+
+    const uint8_t* m_base{nullptr};
+    std::vector<uint32_t> m_payload_offset;
+    std::vector<uint32_t> m_payload_length;
+    std::vector<uint32_t> m_seconds;
+    std::vector<uint64_t> m_picoseconds;
+    std::vector<uint32_t> m_stream_id;
+    std::vector<uint16_t> m_sequence;
+    std::vector<packet_kind> m_kind;
+    v49::layout_cache m_layouts;
+
+    auto clear(const uint8_t* base) -> void {
+        m_base = base;
+        m_payload_offset.clear();
+        m_payload_length.clear();
+        m_seconds.clear();
+        m_picoseconds.clear();
+        m_stream_id.clear();
+        m_sequence.clear();
+        m_kind.clear();
+    }
+
+    auto reserve(std::size_t count) -> void {
+        m_payload_offset.reserve(count);
+        m_payload_length.reserve(count);
+        m_seconds.reserve(count);
+        m_picoseconds.reserve(count);
+        m_stream_id.reserve(count);
+        m_sequence.reserve(count);
+        m_kind.reserve(count);
+    }
+
+    auto push_back(
+        const uint8_t* payload,
+        std::size_t length,
+        uint32_t seconds,
+        uint64_t picoseconds,
+        uint32_t stream_id,
+        uint16_t sequence,
+        packet_kind kind
+    ) -> void {
+        m_payload_offset.push_back(payload == nullptr ? 0 : static_cast<uint32_t>(payload - m_base));
+        m_payload_length.push_back(static_cast<uint32_t>(length));
+        m_seconds.push_back(seconds);
+        m_picoseconds.push_back(picoseconds);
+        m_stream_id.push_back(stream_id);
+        m_sequence.push_back(sequence);
+        m_kind.push_back(kind);
+    }
+
+    auto parse_datagram(framing::sdds, std::span<const uint8_t> datagram, int64_t) -> void {
+        if (datagram.size() < SDDS_MIN_LEN) {
+            push_back(nullptr, 0, 0, 0, 0, 0, packet_kind::OTHER);
+            return;
+        }
+        auto packet = sdds::overlay(datagram);
+        auto payload = packet.payload<uint8_t>();
+        // Parity frames carry no samples
+        auto kind = framing::numbering<framing::sdds>().parity(packet.seq()) ? packet_kind::OTHER : packet_kind::DATA;
+        push_back(payload.data(), payload.size(), packet.secs(), packet.psecs(), 0, packet.seq(), kind);
+    }
+
+    auto parse_datagram(framing::vita49, std::span<const uint8_t> datagram, int64_t) -> void {
+        if (datagram.size() < VITA49_MIN_LEN) {
+            push_back(nullptr, 0, 0, 0, 0, 0, packet_kind::OTHER);
+            return;
+        }
+        auto packet = v49::overlay(datagram, m_layouts);
+        // Truncated (or lying) packets would have the fields read past the datagram
+        if (!packet.complete()) {
+            push_back(nullptr, 0, 0, 0, 0, 0, packet_kind::OTHER);
+            return;
+        }
+        auto kind = packet.is_data() ? packet_kind::DATA : (packet.is_context() ? packet_kind::CONTEXT : packet_kind::OTHER);
+        auto payload = packet.payload<uint8_t>();
+        push_back(
+            payload.data(),
+            payload.size(),
+            packet.integer_timestamp().value_or(0),
+            packet.fractional_timestamp().value_or(0),
+            packet.stream_id().value_or(0),
+            packet.packet_count(),
+            kind
+        );
+    }
+
+    auto parse_datagram(framing::raw, std::span<const uint8_t> datagram, int64_t received) -> void {
+        auto time = batch::to_timestamp(received);
+        push_back(datagram.data(), datagram.size(), time.seconds, time.picoseconds, 0, 0, packet_kind::DATA);
+    }
+
+}; // class descriptor_table
+
+// Descriptors of a batch for a transport, decoded by the first consumer to ask
+// and shared with every other consumer of the same batch
+inline auto descriptors(const batch::packet_batch& batch, transport kind) -> const descriptor_table& {
+    return batch.decoded<descriptor_table>(static_cast<int>(kind), [kind](descriptor_table& table, const batch::packet_batch& data) {
+        (table.*descriptor_table::parser(kind))(data);
+    });
+}
+
 } // namespace overlay
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace batch {
+
+// Time as whole seconds since the epoch and picoseconds into the second
+struct timestamp {
+    uint32_t seconds{};
+    uint64_t picoseconds{};
+};
+
+// Splits a receive time in ns since the epoch into any {seconds, picoseconds} type
+template<typename Timestamp = timestamp>
+inline auto to_timestamp(int64_t ns) -> Timestamp {
+    constexpr auto NS_PER_SEC = int64_t{1'000'000'000};
+    constexpr auto PS_PER_NS = uint64_t{1'000};
+    return {static_cast<uint32_t>(ns / NS_PER_SEC), static_cast<uint64_t>(ns % NS_PER_SEC) * PS_PER_NS};
+}
+
+/*
+ * Datagrams received together by a source component. Each datagram is a view
+ * into memory owned by the source (a pooled buffer, a PACKET_MMAP block, ...),
+ * which is kept alive by the shared_ptr the batch is delivered through.
+ * Sources that can read the kernel receive time also record it per datagram,
+ * as nanoseconds since the Unix epoch (0 when not known).
+ *
+ * A batch also carries its decoded form (see decoded()), so consumers that
+ * share a batch parse it once between them.
+ */
+class packet_batch {
+public:
+    struct entry {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    packet_batch() = default;
+
+    explicit packet_batch(std::size_t capacity) {
+        m_entries.reserve(capacity);
+        m_timestamps.reserve(capacity);
+    }
+
+    auto reset(const uint8_t* base) -> void {
+        m_base = base;
+        m_entries.clear();
+        m_timestamps.clear();
+        // Only the source touches a batch it is refilling, and the tables
+        // keep their storage for the next fill
+        for (auto& table : m_decoded.tables) {
+            table.valid = false;
+        }
+    }
+
+    auto push_back(std::size_t offset, std::size_t length, int64_t timestamp = 0) -> void {
+        m_entries.push_back({static_cast<uint32_t>(offset), static_cast<uint32_t>(length)});
+        m_timestamps.push_back(timestamp);
+    }
+
+    auto operator[](std::size_t idx) const -> std::span<const uint8_t> {
+        const auto& entry = m_entries[idx];
+        return {m_base + entry.offset, entry.length};
+    }
+
+    auto at(std::size_t idx) const -> std::span<const uint8_t> {
+        if (idx >= size()) {
+            throw std::out_of_range("packet_batch: index out of range");
+        }
+        return (*this)[idx];
+    }
+
+    // Kernel receive time of a datagram in ns since the epoch, 0 if unknown
+    auto timestamp(std::size_t idx) const -> int64_t {
+        return m_timestamps[idx];
+    }
+
+    auto timestamps() const -> std::span<const int64_t> {
+        return m_timestamps;
+    }
+
+    auto data() const -> const uint8_t* {
+        return m_base;
+    }
+
+    auto size() const -> std::size_t {
+        return m_entries.size();
+    }
+
+    auto empty() const -> bool {
+        return m_entries.empty();
+    }
+
+    // Index of the source receiver that produced this batch
+    auto receiver() const -> uint32_t {
+        return m_receiver;
+    }
+
+    auto set_receiver(uint32_t receiver) -> void {
+        m_receiver = receiver;
+    }
+
+    /*
+     * Table of kind decoded from this batch. The first consumer to ask fills
+     * it with build(table, batch); later ones, on any thread, get the same
+     * read-only table until the source resets the batch.
+     */
+    template<typename Table, typename Build>
+    auto decoded(int kind, Build&& build) const -> const Table& {
+        auto lk = std::scoped_lock{m_decoded.mtx};
+        auto it = m_decoded.tables.begin();
+        while (it != m_decoded.tables.end() && it->kind != kind) {
+            ++it;
+        }
+        if (it == m_decoded.tables.end()) {
+            it = m_decoded.tables.insert(it, {kind, false, std::make_shared<Table>()});
+        }
+        auto& table = *std::static_pointer_cast<Table>(it->table);
+        if (!it->valid) {
+            build(table, *this);
+            it->valid = true;
+        }
+        return table;
+    }
+
+private:
+    struct decoded_table {
+        int kind;
+        bool valid;
+        std::shared_ptr<void> table;
+    };
+
+    // Moving a batch hands over its datagrams, not its decoded tables
+    struct decoded_tables {
+        std::mutex mtx;
+        std::vector<decoded_table> tables;
+
+        decoded_tables() = default;
+        decoded_tables(decoded_tables&&) noexcept {}
+        auto operator=(decoded_tables&&) noexcept -> decoded_tables& {
+            return *this;
+        }
+    };
+
+    const uint8_t* m_base{nullptr};
+    uint32_t m_receiver{};
+    std::vector<entry> m_entries;
+    std::vector<int64_t> m_timestamps;
+    mutable decoded_tables m_decoded;
+
+}; // class packet_batch
+
+} // namespace batch
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace sequence {
+
+// Running totals of sequence anomalies seen on one or more streams
+struct counters {
+    uint64_t received{};
+    uint64_t gaps{};        // jumps forward past the expected count
+    uint64_t lost{};        // packets skipped over by those jumps
+    uint64_t duplicates{};  // repeats of the last count
+    uint64_t reordered{};   // counts older than the last one
+
+    auto operator+=(const counters& other) -> counters& {
+        received += other.received;
+        gaps += other.gaps;
+        lost += other.lost;
+        duplicates += other.duplicates;
+        reordered += other.reordered;
+        return *this;
+    }
+};
+
+/*
+ * How a transport numbers its packets: a wrapping counter of the given width
+ * which, with a parity period, reserves the last count of every period for
+ * parity packets (SDDS: seq % 32 == 31). Data packets skip those counts,
+ * whether or not the sender emits parity, so index() squeezes them out to
+ * number data packets consecutively.
+ */
+struct numbering {
+    unsigned bits{32};
+    uint32_t parity_period{};  // 0 = no reserved counts
+
+    auto parity(uint32_t count) const -> bool {
+        return parity_period > 0 && (count & mask()) % parity_period == parity_period - 1;
+    }
+
+    // Position of a data packet's count among the data counts
+    auto index(uint32_t count) const -> uint32_t {
+        count &= mask();
+        return parity_period > 0 ? count - count / parity_period : count;
+    }
+
+    // Number of data counts before the counter wraps
+    auto modulus() const -> uint64_t {
+        auto counts = uint64_t{1} << bits;
+        return parity_period > 0 ? counts - counts / parity_period : counts;
+    }
+
+    auto mask() const -> uint32_t {
+        return static_cast<uint32_t>((uint64_t{1} << bits) - 1);
+    }
+};
+
+/*
+ * Follows a wrapping packet counter. A count up to half the modulus ahead of
+ * the expected one is taken as loss, anything behind it as a late
+ * (reordered) packet, which does not move the expected count. Parity counts
+ * are not data and are ignored.
+ */
+class tracker {
+public:
+    explicit tracker(numbering counter) :
+      m_numbering(counter),
+      m_modulus(counter.modulus()) {}
+
+    auto update(uint32_t count) -> void {
+        if (m_numbering.parity(count)) {
+            return;
+        }
+        ++m_counters.received;
+        auto index = uint64_t{m_numbering.index(count)};
+        if (!m_started) {
+            m_started = true;
+            m_last = index;
+            return;
+        }
+        if (index == m_last) {
+            ++m_counters.duplicates;
+            return;
+        }
+        auto ahead = (index + m_modulus - m_last - 1) % m_modulus;
+        if (ahead < m_modulus / 2) {
+            if (ahead > 0) {
+                ++m_counters.gaps;
+                m_counters.lost += ahead;
+            }
+            m_last = index;
+        } else {
+            ++m_counters.reordered;
+        }
+    }
+
+    auto counters() const -> const sequence::counters& {
+        return m_counters;
+    }
+
+private:
+    numbering m_numbering;
+    uint64_t m_modulus;
+    bool m_started{false};
+    uint64_t m_last{};
+    sequence::counters m_counters;
+
+}; // class tracker
+
+// One tracker per stream identifier
+class stream_trackers {
+public:
+    explicit stream_trackers(numbering counter = {}) :
+      m_numbering(counter) {}
+
+    auto update(uint32_t stream_id, uint32_t count) -> void {
+        m_trackers.try_emplace(stream_id, m_numbering).first->second.update(count);
+    }
+
+    auto streams() const -> const std::unordered_map<uint32_t, tracker>& {
+        return m_trackers;
+    }
+
+    auto totals() const -> counters {
+        auto sum = counters{};
+        for (const auto& [_, trk] : m_trackers) {
+            sum += trk.counters();
+        }
+        return sum;
+    }
+
+private:
+    numbering m_numbering;
+    std::unordered_map<uint32_t, tracker> m_trackers;
+
+}; // class stream_trackers
+
+} // namespace sequence
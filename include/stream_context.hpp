@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <stream_context_fwd.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+
+namespace metadata {
+
+/*
+ * Signal description of one stream as last reported by its context packets.
+ * Fields are empty until a context packet has carried them.
+ * Frequencies are in Hz, the reference level in dBm.
+ */
+struct stream_context {
+    uint32_t stream_id{};
+    std::optional<double> sample_rate;
+    std::optional<double> bandwidth;
+    std::optional<double> rf_reference_frequency;
+    std::optional<double> reference_level;
+
+    auto operator==(const stream_context&) const -> bool = default;
+};
+
+/*
+ * Latest context of each stream. A new immutable snapshot is published only
+ * when a value changes, so frames can carry a shared pointer to it and
+ * consumers can detect changes by pointer comparison.
+ */
+class context_cache {
+public:
+    using context_ptr = metadata::context_ptr;
+
+    // Records a decoded context, returns true if it changed anything
+    auto update(const stream_context& context) -> bool {
+        auto& current = m_contexts[context.stream_id];
+        if (current != nullptr && *current == context) {
+            return false;
+        }
+        current = std::make_shared<const stream_context>(context);
+        ++m_changes;
+        return true;
+    }
+
+    auto get(uint32_t stream_id) const -> context_ptr {
+        auto found = m_contexts.find(stream_id);
+        return found == m_contexts.end() ? nullptr : found->second;
+    }
+
+    // Context of a stream, adding an empty one (just the stream ID) if none was seen yet
+    auto get_or_add(uint32_t stream_id) -> context_ptr {
+        auto& current = m_contexts[stream_id];
+        if (current == nullptr) {
+            auto context = stream_context{};
+            context.stream_id = stream_id;
+            current = std::make_shared<const stream_context>(context);
+        }
+        return current;
+    }
+
+    // Starting point for merging a context packet that only carries some fields
+    auto current(uint32_t stream_id) const -> stream_context {
+        if (auto context = get(stream_id); context != nullptr) {
+            return *context;
+        }
+        auto context = stream_context{};
+        context.stream_id = stream_id;
+        return context;
+    }
+
+    auto changes() const -> uint64_t {
+        return m_changes;
+    }
+
+private:
+    std::unordered_map<uint32_t, context_ptr> m_contexts;
+    uint64_t m_changes{};
+
+}; // class context_cache
+
+} // namespace metadata
@@ -33,8 +33,8 @@ constexpr std::size_t ALIGNMENT = 64;
  * Reference: https://www.mathworks.com/help/signal/ref/blackmanharris.html
  */
 template <typename T>
-auto blackman_harris(const std::size_t length, bool complex=true) {
-    auto window = aligned::make_aligned<T>(ALIGNMENT, length * (complex ? 2 : 1));
+auto blackman_harris(const std::size_t length, bool complex=true, aligned::pool& from=aligned::pool::global()) {
+    auto window = aligned::make_aligned<T>(ALIGNMENT, length * (complex ? 2 : 1), from);
 
     constexpr T a0 = 0.35875;
     constexpr T a1 = 0.48829;
@@ -63,8 +63,8 @@ auto blackman_harris(const std::size_t length, bool complex=true) {
  * Reference: https://www.mathworks.com/help/signal/ref/hamming.html
  */
 template <typename T>
-auto hamming(const std::size_t length, bool complex=true) {
-    auto window = aligned::make_aligned<T>(ALIGNMENT, length *  (complex ? 2 : 1));
+auto hamming(const std::size_t length, bool complex=true, aligned::pool& from=aligned::pool::global()) {
+    auto window = aligned::make_aligned<T>(ALIGNMENT, length *  (complex ? 2 : 1), from);
 
     constexpr T a0 = 0.54;
     constexpr T a1 = 0.46;
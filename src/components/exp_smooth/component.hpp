@@ -26,8 +26,8 @@
 template <typename T>
 class exp_smooth : public composite::component {
     using input_t = aligned::aligned_mem<T>;
-    using input_port_t = composite::input_port<std::unique_ptr<input_t>>;
-    using output_port_t = composite::output_port<std::unique_ptr<input_t>>;
+    using input_port_t = composite::input_port<aligned::shared_mem<T>>;
+    using output_port_t = composite::output_port<aligned::shared_mem<T>>;
 public:
     exp_smooth() : composite::component("exp_smooth") {
         add_port(m_in_port.get());
@@ -58,8 +58,8 @@ public:
             m_prev_psd_ts = ts;
             return NORMAL;
         }
-        // Run algorithm
-        m_work->process(data.get(), m_prev_psd.get());
+        // Run algorithm, in place unless another consumer shares the frame
+        m_work->process(aligned::writable(data), m_prev_psd.get());
         // Send previous PSD data and timestamp
         m_out_port->send_data(std::move(m_prev_psd), m_prev_psd_ts);
         // Save current PSD for next pass
@@ -35,7 +35,7 @@ public:
         m_one_minus_alpha_vec = _mm512_set1_ps(1 - alpha);
     }
 
-    auto process(psd_data_t* curr_psd, psd_data_t* prev_psd) const -> void {
+    auto process(psd_data_t* curr_psd, const psd_data_t* prev_psd) const -> void {
         for (auto i=0u; i < curr_psd->size(); i += 16) {
             // Load data
             auto curr_data = _mm512_load_ps(curr_psd->data() + i);
@@ -64,7 +64,7 @@ public:
         m_one_minus_alpha_vec = _mm512_set1_pd(1 - alpha);
     }
 
-    auto process(psd_data_t* curr_psd, psd_data_t* prev_psd) const -> void {
+    auto process(psd_data_t* curr_psd, const psd_data_t* prev_psd) const -> void {
         for (auto i=0u; i < curr_psd->size(); i += 8) {
             // Load data
             auto curr_data = _mm512_load_pd(curr_psd->data() + i);
@@ -18,15 +18,18 @@
  */
 
 #include "aligned_mem.hpp"
+#include "alloc_policy.hpp"
 #include "apply_window.hpp"
 #include "fft_plan.hpp"
 #include "overlay.hpp"
 #include "windows.hpp"
+#include "wisdom.hpp"
 
 #include <composite/component.hpp>
 #include <complex>
 #include <fftw3.h>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 template <typename T>
@@ -34,8 +37,8 @@ class fft : public composite::component {
     using plan_t = fft_plan<T, true>;
     using fft_t = aligned::aligned_mem<std::complex<T>>;
     using window_t = aligned::aligned_mem<T>;
-    using input_port_t = composite::input_port<std::unique_ptr<fft_t>>;
-    using output_port_t = composite::output_port<std::unique_ptr<fft_t>>;
+    using input_port_t = composite::input_port<aligned::shared_mem<std::complex<T>>>;
+    using output_port_t = composite::output_port<aligned::shared_mem<std::complex<T>>>;
 public:
     fft() : composite::component("fft") {
         add_port(m_in_port.get());
@@ -44,19 +47,32 @@ public:
         add_property("fft_size", &m_fft_size);
         add_property("fftw_threads", &m_fftw_threads);
         add_property("shift", &m_shift);
+        add_property("planner", &m_planner);
+        add_property("wisdom_file", &m_wisdom_file);
+        add_property("memory", &m_memory);
+        add_property("numa_node", &m_numa_node);
     }
 
     ~fft() override = default;
 
     auto initialize() -> void override {
+        auto policy = aligned::parse_alloc_policy(m_memory, m_numa_node);
+        if (!policy) {
+            throw std::runtime_error("fft: invalid memory " + m_memory + " or numa_node " + m_numa_node);
+        }
+        m_pool = &aligned::pool::get(*policy);
         // Init window
         if (m_window_type == "BLACKMAN_HARRIS") {
-            m_window = windows::blackman_harris<T>(m_fft_size);
+            m_window = windows::blackman_harris<T>(m_fft_size, true, *m_pool);
         } else if (m_window_type == "HAMMING") {
-            m_window = windows::hamming<T>(m_fft_size);
+            m_window = windows::hamming<T>(m_fft_size, true, *m_pool);
         }
         // Init fftw
-        m_fft_plan = std::make_unique<plan_t>(m_fft_size, m_fftw_threads, m_shift);
+        auto flags = wisdom::parse_planner(m_planner);
+        if (!flags) {
+            throw std::runtime_error("fft: unknown planner " + m_planner);
+        }
+        m_fft_plan = std::make_unique<plan_t>(m_fft_size, m_fftw_threads, m_shift, *flags, m_wisdom_file);
     }
 
     auto process() -> composite::retval override {
@@ -65,21 +81,24 @@ public:
         if (data == nullptr) {
             return NORMAL;
         }
+        // In place, unless another consumer shares the frame; the copy then
+        // comes from this stage's pool
+        auto* frame = aligned::writable(data, m_pool);
         // Apply window
         if (m_window) {
             auto i=0u;
             auto stride = 32u / sizeof(T);
-            for (; i < data->size(); i += stride) {
+            for (; i < frame->size(); i += stride) {
                 apply_window(
-                    reinterpret_cast<const typename fft_t::value_type::value_type*>(data->data() + i),
+                    reinterpret_cast<const typename fft_t::value_type::value_type*>(frame->data() + i),
                     m_window->data() + i * 2,
-                    reinterpret_cast<typename fft_t::value_type::value_type*>(data->data() + i)
+                    reinterpret_cast<typename fft_t::value_type::value_type*>(frame->data() + i)
                 );
             }
         }
         // Execute the fft
         // In-place for complex
-        m_fft_plan->execute(data.get(), data.get());
+        m_fft_plan->execute(frame, frame);
         // Send data
         m_out_port->send_data(std::move(data), ts);
         return NORMAL;
@@ -95,9 +114,14 @@ private:
     uint32_t m_fft_size{1024};
     uint32_t m_fftw_threads{1};
     bool m_shift{true};
+    std::string m_planner{"MEASURE"};
+    std::string m_wisdom_file;
+    std::string m_memory{"default"};
+    std::string m_numa_node;
 
     // Members
     std::unique_ptr<fft_plan<T, true>> m_fft_plan{nullptr};
     std::unique_ptr<window_t> m_window{nullptr};
+    aligned::pool* m_pool{&aligned::pool::global()};
 
 }; // class fft
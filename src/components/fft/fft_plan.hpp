@@ -20,11 +20,13 @@
 #pragma once
 
 #include "aligned_mem.hpp"
+#include "plan_cache.hpp"
 #include "windows.hpp"
 
 #include <algorithm>
 #include <complex>
 #include <fftw3.h>
+#include <string>
 
 template <typename T>
 auto shift(aligned::aligned_mem<T>* out) {
@@ -41,31 +43,17 @@ class fft_plan{};
 template <>
 class fft_plan<float, true> {
 public:
-    fft_plan(uint32_t fft_size, uint32_t fftw_threads, bool do_shift) : m_shift(do_shift) {
-        fftwf_init_threads();
-        fftwf_plan_with_nthreads(fftw_threads);
-        auto plan_buf = aligned::make_aligned<std::complex<float>>(64, fft_size);
-        m_plan = fftwf_plan_dft_1d(
-            fft_size,
-            reinterpret_cast<fftwf_complex*>(plan_buf->data()),
-            reinterpret_cast<fftwf_complex*>(plan_buf->data()),
-            FFTW_FORWARD,
-            FFTW_MEASURE
-        );
-    }
-
-    ~fft_plan() {
-        fftwf_cleanup_threads();
-        fftwf_destroy_plan(m_plan);
-    }
+    fft_plan(uint32_t fft_size, uint32_t fftw_threads, bool do_shift, unsigned flags = FFTW_MEASURE, const std::string& wisdom_file = {}) :
+      m_plan(plan_cache<float>::global().get({fft_size, true, FFTW_FORWARD, fftw_threads, flags}, wisdom_file)),
+      m_shift(do_shift) {}
 
     auto plan() -> fftwf_plan {
-        return m_plan;
+        return m_plan.get();
     }
 
     auto execute(aligned::aligned_mem<std::complex<float>>* in, aligned::aligned_mem<std::complex<float>>* out) -> void {
         fftwf_execute_dft(
-            m_plan,
+            m_plan.get(),
             reinterpret_cast<fftwf_complex*>(in->data()),
             reinterpret_cast<fftwf_complex*>(out->data())
         );
@@ -76,7 +64,7 @@ public:
     }
 
 private:
-    fftwf_plan m_plan;
+    plan_cache<float>::plan_ptr m_plan;
     bool m_shift{false};
 
 }; // class fft_plan<float, true>
@@ -84,31 +72,17 @@ private:
 template <>
 class fft_plan<float, false> {
 public:
-    fft_plan(uint32_t fft_size, uint32_t fftw_threads, bool do_shift) : m_shift(do_shift) {
-        fftwf_init_threads();
-        fftwf_plan_with_nthreads(fftw_threads);
-        auto in_buf = aligned::make_aligned<float>(64, fft_size);
-        auto out_buf = aligned::make_aligned<std::complex<float>>(64, fft_size);
-        m_plan = fftwf_plan_dft_r2c_1d(
-            fft_size,
-            in_buf->data(),
-            reinterpret_cast<fftwf_complex*>(out_buf->data()),
-            FFTW_MEASURE
-        );
-    }
-
-    ~fft_plan() {
-        fftwf_cleanup_threads();
-        fftwf_destroy_plan(m_plan);
-    }
+    fft_plan(uint32_t fft_size, uint32_t fftw_threads, bool do_shift, unsigned flags = FFTW_MEASURE, const std::string& wisdom_file = {}) :
+      m_plan(plan_cache<float>::global().get({fft_size, false, FFTW_FORWARD, fftw_threads, flags}, wisdom_file)),
+      m_shift(do_shift) {}
 
     auto plan() -> fftwf_plan {
-        return m_plan;
+        return m_plan.get();
     }
 
     auto execute(aligned::aligned_mem<float>* in, aligned::aligned_mem<std::complex<float>>* out) -> void {
         fftwf_execute_dft_r2c(
-            m_plan,
+            m_plan.get(),
             in->data(),
             reinterpret_cast<fftwf_complex*>(out->data())
         );
@@ -120,7 +94,7 @@ public:
 
 
 private:
-    fftwf_plan m_plan;
+    plan_cache<float>::plan_ptr m_plan;
     bool m_shift{false};
 
 }; // class fft_plan<float, false>
@@ -128,31 +102,17 @@ private:
 template <>
 class fft_plan<double, true> {
 public:
-    fft_plan(uint32_t fft_size, uint32_t fftw_threads, bool do_shift) : m_shift(do_shift) {
-        fftw_init_threads();
-        fftw_plan_with_nthreads(fftw_threads);
-        auto plan_buf = aligned::make_aligned<std::complex<double>>(64, fft_size);
-        m_plan = fftw_plan_dft_1d(
-            fft_size,
-            reinterpret_cast<fftw_complex*>(plan_buf->data()),
-            reinterpret_cast<fftw_complex*>(plan_buf->data()),
-            FFTW_FORWARD,
-            FFTW_MEASURE
-        );
-    }
-
-    ~fft_plan() {
-        fftw_cleanup_threads();
-        fftw_destroy_plan(m_plan);
-    }
+    fft_plan(uint32_t fft_size, uint32_t fftw_threads, bool do_shift, unsigned flags = FFTW_MEASURE, const std::string& wisdom_file = {}) :
+      m_plan(plan_cache<double>::global().get({fft_size, true, FFTW_FORWARD, fftw_threads, flags}, wisdom_file)),
+      m_shift(do_shift) {}
 
     auto plan() -> fftw_plan {
-        return m_plan;
+        return m_plan.get();
     }
 
     auto execute(aligned::aligned_mem<std::complex<double>>* in, aligned::aligned_mem<std::complex<double>>* out) -> void {
         fftw_execute_dft(
-            m_plan,
+            m_plan.get(),
             reinterpret_cast<fftw_complex*>(in->data()),
             reinterpret_cast<fftw_complex*>(out->data())
         );
@@ -163,7 +123,7 @@ public:
     }
 
 private:
-    fftw_plan m_plan;
+    plan_cache<double>::plan_ptr m_plan;
     bool m_shift{false};
 
 }; // class fft_plan<double, true>
@@ -171,31 +131,17 @@ private:
 template <>
 class fft_plan<double, false> {
 public:
-    fft_plan(uint32_t fft_size, uint32_t fftw_threads, bool do_shift) : m_shift(do_shift) {
-        fftw_init_threads();
-        fftw_plan_with_nthreads(fftw_threads);
-        auto in_buf = aligned::make_aligned<double>(64, fft_size);
-        auto out_buf = aligned::make_aligned<std::complex<double>>(64, fft_size);
-        m_plan = fftw_plan_dft_r2c_1d(
-            fft_size,
-            in_buf->data(),
-            reinterpret_cast<fftw_complex*>(out_buf->data()),
-            FFTW_MEASURE
-        );
-    }
-
-    ~fft_plan() {
-        fftw_cleanup_threads();
-        fftw_destroy_plan(m_plan);
-    }
+    fft_plan(uint32_t fft_size, uint32_t fftw_threads, bool do_shift, unsigned flags = FFTW_MEASURE, const std::string& wisdom_file = {}) :
+      m_plan(plan_cache<double>::global().get({fft_size, false, FFTW_FORWARD, fftw_threads, flags}, wisdom_file)),
+      m_shift(do_shift) {}
 
     auto plan() -> fftw_plan {
-        return m_plan;
+        return m_plan.get();
     }
 
     auto execute(aligned::aligned_mem<double>* in, aligned::aligned_mem<std::complex<double>>* out) -> void {
         fftw_execute_dft_r2c(
-            m_plan,
+            m_plan.get(),
             in->data(),
             reinterpret_cast<fftw_complex*>(out->data())
         );
@@ -206,7 +152,7 @@ public:
     }
 
 private:
-    fftw_plan m_plan;
+    plan_cache<double>::plan_ptr m_plan;
     bool m_shift{false};
 
 }; // class fft_plan<double, false>
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include "aligned_mem.hpp"
+#include "wisdom.hpp"
+
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <fftw3.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+template <typename T>
+struct fftw_api {};
+
+template <>
+struct fftw_api<float> {
+    using plan_type = fftwf_plan;
+    using complex_type = fftwf_complex;
+
+    static auto init_threads() -> void {
+        fftwf_init_threads();
+    }
+
+    static auto cleanup_threads() -> void {
+        fftwf_cleanup_threads();
+    }
+
+    static auto plan_with_nthreads(uint32_t threads) -> void {
+        fftwf_plan_with_nthreads(static_cast<int>(threads));
+    }
+
+    static auto plan_dft_1d(uint32_t size, complex_type* in, complex_type* out, int direction, unsigned flags) -> plan_type {
+        return fftwf_plan_dft_1d(static_cast<int>(size), in, out, direction, flags);
+    }
+
+    static auto plan_dft_r2c_1d(uint32_t size, float* in, complex_type* out, unsigned flags) -> plan_type {
+        return fftwf_plan_dft_r2c_1d(static_cast<int>(size), in, out, flags);
+    }
+
+    static auto destroy_plan(plan_type plan) -> void {
+        fftwf_destroy_plan(plan);
+    }
+}; // struct fftw_api<float>
+
+template <>
+struct fftw_api<double> {
+    using plan_type = fftw_plan;
+    using complex_type = fftw_complex;
+
+    static auto init_threads() -> void {
+        fftw_init_threads();
+    }
+
+    static auto cleanup_threads() -> void {
+        fftw_cleanup_threads();
+    }
+
+    static auto plan_with_nthreads(uint32_t threads) -> void {
+        fftw_plan_with_nthreads(static_cast<int>(threads));
+    }
+
+    static auto plan_dft_1d(uint32_t size, complex_type* in, complex_type* out, int direction, unsigned flags) -> plan_type {
+        return fftw_plan_dft_1d(static_cast<int>(size), in, out, direction, flags);
+    }
+
+    static auto plan_dft_r2c_1d(uint32_t size, double* in, complex_type* out, unsigned flags) -> plan_type {
+        return fftw_plan_dft_r2c_1d(static_cast<int>(size), in, out, flags);
+    }
+
+    static auto destroy_plan(plan_type plan) -> void {
+        fftw_destroy_plan(plan);
+    }
+}; // struct fftw_api<double>
+
+/*
+ * Process-wide cache of FFTW plans of one precision, so pipelines using the
+ * same transform plan it once and share it. Plans are only created and
+ * destroyed under wisdom::planner_mutex(); executing a shared plan on the
+ * caller's own arrays (fftw_execute_dft and friends) is thread safe, as long
+ * as they are 64 byte aligned like the planning buffers and, for complex
+ * transforms, in place.
+ *
+ * FFTW threads are initialized when the first plan is made and cleaned up
+ * when the last one is destroyed. The cache only holds weak references, so
+ * a plan lives as long as some fft_plan uses it.
+ */
+template <typename T>
+class plan_cache {
+    using api = fftw_api<T>;
+public:
+    using plan_type = typename api::plan_type;
+    using plan_ptr = std::shared_ptr<std::remove_pointer_t<plan_type>>;
+
+    struct key {
+        uint32_t size{};
+        bool complex{true};
+        int direction{FFTW_FORWARD};
+        uint32_t threads{1};
+        unsigned flags{FFTW_MEASURE};
+
+        auto operator<=>(const key&) const = default;
+    };
+
+    static auto global() -> plan_cache& {
+        static auto* instance = new plan_cache();
+        return *instance;
+    }
+
+    auto get(const key& params, const std::string& wisdom_file = {}) -> plan_ptr {
+        auto guard = std::lock_guard(wisdom::planner_mutex());
+        std::erase_if(m_plans, [](const auto& entry) {
+            return entry.second.expired();
+        });
+        if (auto found = m_plans.find(params); found != m_plans.end()) {
+            if (auto plan = found->second.lock()) {
+                return plan;
+            }
+        }
+        if (m_users++ == 0) {
+            api::init_threads();
+        }
+        auto planned = plan_type{};
+        {
+            auto planner = wisdom::scope<T>(wisdom_file, params.flags);
+            api::plan_with_nthreads(params.threads);
+            if (params.complex) {
+                auto buf = aligned::make_aligned<std::complex<T>>(64, params.size);
+                auto* data = reinterpret_cast<typename api::complex_type*>(buf->data());
+                planned = api::plan_dft_1d(params.size, data, data, params.direction, params.flags);
+            } else {
+                auto in_buf = aligned::make_aligned<T>(64, params.size);
+                auto out_buf = aligned::make_aligned<std::complex<T>>(64, params.size);
+                planned = api::plan_dft_r2c_1d(
+                    params.size,
+                    in_buf->data(),
+                    reinterpret_cast<typename api::complex_type*>(out_buf->data()),
+                    params.flags
+                );
+            }
+        }
+        auto plan = plan_ptr(planned, [this](plan_type expired) {
+            auto guard = std::lock_guard(wisdom::planner_mutex());
+            if (expired != nullptr) {
+                api::destroy_plan(expired);
+            }
+            if (--m_users == 0) {
+                api::cleanup_threads();
+            }
+        });
+        m_plans[params] = plan;
+        return plan;
+    }
+
+    // Plans currently alive
+    auto size() -> std::size_t {
+        auto guard = std::lock_guard(wisdom::planner_mutex());
+        return static_cast<std::size_t>(std::count_if(m_plans.begin(), m_plans.end(), [](const auto& entry) {
+            return !entry.second.expired();
+        }));
+    }
+
+private:
+    std::map<key, std::weak_ptr<std::remove_pointer_t<plan_type>>> m_plans;
+    std::size_t m_users{};
+
+    plan_cache() = default;
+
+}; // class plan_cache
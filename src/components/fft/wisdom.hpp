@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <fftw3.h>
+
+#include <cstdio>
+#include <fcntl.h>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace wisdom {
+
+// FFTW planner rigor from its name: ESTIMATE, MEASURE, PATIENT or EXHAUSTIVE
+inline auto parse_planner(std::string_view planner) -> std::optional<unsigned> {
+    if (planner == "ESTIMATE") {
+        return FFTW_ESTIMATE;
+    } else if (planner == "MEASURE") {
+        return FFTW_MEASURE;
+    } else if (planner == "PATIENT") {
+        return FFTW_PATIENT;
+    } else if (planner == "EXHAUSTIVE") {
+        return FFTW_EXHAUSTIVE;
+    }
+    return {};
+}
+
+/*
+ * The FFTW planner (planning, destroying plans and wisdom) is not thread
+ * safe, so every fft instance in the process serializes on this mutex. As
+ * an inline function's static it is shared across the component libraries.
+ */
+inline auto planner_mutex() -> std::mutex& {
+    static auto* mutex = new std::mutex();
+    return *mutex;
+}
+
+template <typename T>
+struct api {};
+
+template <>
+struct api<float> {
+    static constexpr const char* SUFFIX = "f";
+
+    static auto import_file(const char* path) -> bool {
+        return fftwf_import_wisdom_from_filename(path) != 0;
+    }
+
+    static auto export_file(const char* path) -> bool {
+        return fftwf_export_wisdom_to_filename(path) != 0;
+    }
+}; // struct api<float>
+
+template <>
+struct api<double> {
+    static constexpr const char* SUFFIX = "";
+
+    static auto import_file(const char* path) -> bool {
+        return fftw_import_wisdom_from_filename(path) != 0;
+    }
+
+    static auto export_file(const char* path) -> bool {
+        return fftw_export_wisdom_to_filename(path) != 0;
+    }
+}; // struct api<double>
+
+// Single and double precision wisdom differ, so like FFTW's own
+// /etc/fftw/wisdom and wisdomf the float file gets an "f" appended
+template <typename T>
+auto path(const std::string& file) -> std::string {
+    return file + api<T>::SUFFIX;
+}
+
+// flock on "<path>.lock", serializing wisdom files between processes
+class file_lock {
+public:
+    file_lock(const std::string& path, int operation) :
+      m_fd(open((path + ".lock").c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644)) {
+        if (m_fd != -1) {
+            flock(m_fd, operation);
+        }
+    }
+
+    ~file_lock() {
+        if (m_fd != -1) {
+            close(m_fd);
+        }
+    }
+
+    file_lock(const file_lock&) = delete;
+    file_lock& operator=(const file_lock&) = delete;
+
+private:
+    int m_fd{-1};
+
+}; // class file_lock
+
+/*
+ * Wraps one planning step, to be held with planner_mutex() locked. With a
+ * wisdom file, the wisdom is imported before planning and, unless the
+ * planner only estimates, the accumulated wisdom is merged back into the
+ * file afterwards: re-imported under an exclusive lock to keep what other
+ * processes added meanwhile, then written to a temporary file renamed over
+ * it, so readers never see a partial file.
+ */
+template <typename T>
+class scope {
+public:
+    scope(const std::string& file, unsigned flags) :
+      m_path(file.empty() ? std::string{} : path<T>(file)),
+      m_export(!file.empty() && (flags & (FFTW_ESTIMATE | FFTW_WISDOM_ONLY)) == 0) {
+        if (!m_path.empty()) {
+            auto lock = file_lock(m_path, LOCK_SH);
+            api<T>::import_file(m_path.c_str());
+        }
+    }
+
+    ~scope() {
+        if (!m_export) {
+            return;
+        }
+        auto lock = file_lock(m_path, LOCK_EX);
+        api<T>::import_file(m_path.c_str());
+        auto tmp = m_path + ".tmp." + std::to_string(getpid());
+        if (!api<T>::export_file(tmp.c_str()) || std::rename(tmp.c_str(), m_path.c_str()) != 0) {
+            unlink(tmp.c_str());
+        }
+    }
+
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+
+private:
+    std::string m_path;
+    bool m_export{false};
+
+}; // class scope
+
+} // namespace wisdom
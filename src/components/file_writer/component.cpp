@@ -46,13 +46,13 @@ auto file_writer::process() -> composite::retval {
     auto curr_total = m_total_bytes;
     using iovec_t = struct iovec;
     auto iovecs = std::vector<iovec_t>{};
-    for (auto& v : *data) {
-        auto packet = overlay::v49::overlay(v);
-        auto& header = packet.header();
-        if (!overlay::v49::is_data(header)) {
+    const auto& table = overlay::descriptors(*data, overlay::transport::VITA49);
+    auto kinds = table.kinds();
+    for (auto idx = size_t{}; idx < table.size(); ++idx) {
+        if (kinds[idx] != overlay::packet_kind::DATA) {
             continue;
         }
-        auto payload = packet.payload<uint8_t>();
+        auto payload = table.payload<uint8_t>(idx);
         iovecs.emplace_back(const_cast<uint8_t*>(payload.data()), payload.size_bytes());
         curr_total += payload.size_bytes();
         if (curr_total >= m_num_bytes) {
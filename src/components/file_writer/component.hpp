@@ -17,11 +17,15 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 
+#include <overlay.hpp>
+#include <packet_batch.hpp>
+
 #include <composite/component.hpp>
 #include <vector>
 
 class file_writer : public composite::component {
-    using input_port_t = composite::input_port<std::vector<std::vector<uint8_t>>>;
+    using input_t = batch::packet_batch;
+    using input_port_t = composite::input_port<std::shared_ptr<input_t>>;
 public:
     file_writer();
     ~file_writer() override;
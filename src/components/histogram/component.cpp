@@ -25,35 +25,53 @@ histogram::histogram() : composite::component("histogram") {
     add_port(m_in_port.get());
     add_port(m_out_port.get());
     add_property("transport", &m_transport);
-    add_property("msg_size", &m_msg_size);
     add_property("byteswap", &m_byteswap);
     add_property("adc_bits", &m_adc_bits);
     add_property("sample_rate", &m_sample_rate);
+    add_property("seq_gaps", &m_seq_gaps);
+    add_property("seq_lost", &m_seq_lost);
+    add_property("seq_duplicates", &m_seq_duplicates);
+    add_property("seq_reordered", &m_seq_reordered);
+    add_property("num_streams", &m_num_streams);
+    add_property("context_changes", &m_context_changes);
 }
 
 auto histogram::initialize() -> void {
+    auto kind = overlay::parse_transport(m_transport);
+    m_kind = kind;
+    m_numbering = kind ? overlay::sequence_numbering(*kind) : sequence::numbering{0, 0};
+    m_seq = sequence::stream_trackers(m_numbering);
     m_histogram = std::make_unique<histogram_t>(static_cast<size_t>(pow(2, m_adc_bits)), 0);
 }
 
 auto histogram::process() -> composite::retval {
     using enum composite::retval;
     auto [data, ts] = m_in_port->get_data();
-    if (data == nullptr) {
+    if (data == nullptr || !m_kind) {
         return NOOP;
     }
     // Histogram
-    for (auto idx = size_t{}; idx < data->size(); idx += m_msg_size) {
-        auto payload = std::span<const std::complex<uint16_t>>{};
-        if (m_transport == "sdds") {
-            auto packet = overlay::sdds::overlay({data->data() + idx, m_msg_size});
-            payload = packet.payload<std::complex<uint16_t>>();
-        } else if (m_transport == "vita49") {
-            auto packet = overlay::v49::overlay({data->data() + idx, m_msg_size});
-            if (auto& header = packet.header(); !overlay::v49::is_data(header)) {
-                continue;
-            }
-            payload = packet.payload<std::complex<uint16_t>>();
+    const auto& table = overlay::descriptors(*data, *m_kind);
+    auto kinds = table.kinds();
+    for (auto idx = size_t{}; idx < table.size(); ++idx) {
+        auto stream = table.stream_ids()[idx];
+        if (kinds[idx] == overlay::packet_kind::CONTEXT) {
+            auto context = m_contexts.current(stream);
+            overlay::v49::parse_context(table.payload<uint8_t>(idx), context);
+            m_contexts.update(context);
+            continue;
+        }
+        if (kinds[idx] != overlay::packet_kind::DATA) {
+            continue;
+        }
+        if (m_numbering.bits > 0) {
+            m_seq.update(stream, table.sequences()[idx]);
         }
+        // Prefer the sample rate the feed reports over the configured one
+        if (auto context = m_contexts.get(stream); context != nullptr && context->sample_rate) {
+            m_stream_sample_rate = *context->sample_rate;
+        }
+        auto payload = table.payload<std::complex<uint16_t>>(idx);
         // Get sample values
         for (auto& sample : payload) {
             auto sample_val = static_cast<int16_t>(m_byteswap ? bswap_16(sample.real()) : sample.real());
@@ -68,8 +86,11 @@ auto histogram::process() -> composite::retval {
             ++m_histogram_samples;
         }
     }
-    // Send histogram data
-    if (m_histogram_samples > static_cast<uint32_t>(m_sample_rate)) {
+    update_seq_counters();
+    m_context_changes = m_contexts.changes();
+    // Send histogram data, about once per second of samples
+    auto sample_rate = m_stream_sample_rate > 0 ? m_stream_sample_rate : double{m_sample_rate};
+    if (m_histogram_samples > static_cast<uint32_t>(sample_rate)) {
         m_out_port->send_data(std::move(m_histogram), ts);
         m_histogram = std::make_unique<histogram_t>(static_cast<size_t>(pow(2, m_adc_bits)), 0);
         m_histogram_samples = 0;
@@ -77,6 +98,15 @@ auto histogram::process() -> composite::retval {
     return NORMAL;
 }
 
+auto histogram::update_seq_counters() -> void {
+    auto totals = m_seq.totals();
+    m_seq_gaps = totals.gaps;
+    m_seq_lost = totals.lost;
+    m_seq_duplicates = totals.duplicates;
+    m_seq_reordered = totals.reordered;
+    m_num_streams = static_cast<uint32_t>(m_seq.streams().size());
+}
+
 extern "C" {
     auto create() -> std::shared_ptr<composite::component> {
         return std::make_shared<histogram>();
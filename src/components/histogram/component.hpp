@@ -17,19 +17,24 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 
+#include <aligned_pool.hpp>
 #include <overlay.hpp>
+#include <packet_batch.hpp>
+#include <sequence.hpp>
+#include <stream_context.hpp>
 
 #include <byteswap.h>
 #include <composite/component.hpp>
 #include <complex>
 #include <cstdint>
 #include <limits>
+#include <optional>
 #include <vector>
 
 class histogram : public composite::component {
-    using input_t = std::vector<uint8_t>;
+    using input_t = batch::packet_batch;
     using input_port_t = composite::input_port<std::shared_ptr<input_t>>;
-    using histogram_t = std::vector<uint64_t>;
+    using histogram_t = std::vector<uint64_t, aligned::pool_allocator<uint64_t>>;
     using output_port_t = composite::output_port<std::unique_ptr<histogram_t>>;
 public:
     histogram();
@@ -44,13 +49,25 @@ private:
 
     // Properties
     std::string m_transport;
-    uint32_t m_msg_size{};
     bool m_byteswap{true};
     uint32_t m_adc_bits{};
     float m_sample_rate{};
+    uint64_t m_seq_gaps{};
+    uint64_t m_seq_lost{};
+    uint64_t m_seq_duplicates{};
+    uint64_t m_seq_reordered{};
+    uint32_t m_num_streams{};
+    uint64_t m_context_changes{};
 
     // Members
     std::unique_ptr<histogram_t> m_histogram;
     uint32_t m_histogram_samples{};
+    std::optional<overlay::transport> m_kind;
+    sequence::numbering m_numbering{0, 0};
+    sequence::stream_trackers m_seq;
+    metadata::context_cache m_contexts;
+    double m_stream_sample_rate{};
+
+    auto update_seq_counters() -> void;
 
 }; // class histogram
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include "capture.hpp"
+
+#include <packet_batch.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace pcapsrc {
+
+/*
+ * Recycles batch descriptors. Batches handed downstream also keep the capture
+ * mapped, since their datagrams are views into it.
+ */
+class batch_pool : public std::enable_shared_from_this<batch_pool> {
+public:
+    batch_pool(std::shared_ptr<const capture> cap, std::size_t num_msgs, std::size_t max_batches) :
+      m_capture(std::move(cap)),
+      m_num_msgs(num_msgs),
+      m_max_batches(max_batches) {}
+
+    // Grows up to max_batches, then waits up to timeout for one to come back
+    // (nullptr if none did), so a fast replay cannot outrun its consumers
+    auto acquire(std::chrono::milliseconds timeout) -> std::unique_ptr<batch::packet_batch> {
+        auto lk = std::unique_lock{m_mtx};
+        if (m_free.empty() && m_created < m_max_batches) {
+            ++m_created;
+            return std::make_unique<batch::packet_batch>(m_num_msgs);
+        }
+        if (!m_released.wait_for(lk, timeout, [this] { return !m_free.empty(); })) {
+            return nullptr;
+        }
+        auto data = std::move(m_free.back());
+        m_free.pop_back();
+        return data;
+    }
+
+    auto share(std::unique_ptr<batch::packet_batch> data) -> std::shared_ptr<batch::packet_batch> {
+        return std::shared_ptr<batch::packet_batch>(data.release(), [pool = shared_from_this()](batch::packet_batch* released) {
+            pool->release(released);
+        });
+    }
+
+private:
+    std::shared_ptr<const capture> m_capture;
+    std::size_t m_num_msgs;
+    std::size_t m_max_batches;
+    std::size_t m_created{};
+    std::mutex m_mtx;
+    std::condition_variable m_released;
+    std::vector<std::unique_ptr<batch::packet_batch>> m_free;
+
+    auto release(batch::packet_batch* data) -> void {
+        {
+            auto lk = std::scoped_lock{m_mtx};
+            m_free.emplace_back(data);
+        }
+        m_released.notify_one();
+    }
+
+}; // class batch_pool
+
+} // namespace pcapsrc
@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "capture.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <bit>
+#include <byteswap.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pcapsrc {
+
+namespace {
+
+constexpr uint32_t PCAP_MAGIC_US = 0xA1B2C3D4;
+constexpr uint32_t PCAP_MAGIC_NS = 0xA1B23C4D;
+constexpr std::size_t PCAP_HEADER_LEN = 24;
+constexpr std::size_t PCAP_RECORD_LEN = 16;
+
+constexpr uint32_t PCAPNG_SHB = 0x0A0D0D0A;
+constexpr uint32_t PCAPNG_IDB = 1;
+constexpr uint32_t PCAPNG_OPB = 2;
+constexpr uint32_t PCAPNG_SPB = 3;
+constexpr uint32_t PCAPNG_EPB = 6;
+constexpr uint32_t PCAPNG_BYTE_ORDER = 0x1A2B3C4D;
+constexpr uint16_t PCAPNG_OPT_END = 0;
+constexpr uint16_t PCAPNG_OPT_TSRESOL = 9;
+
+constexpr uint32_t LINKTYPE_NULL = 0;
+constexpr uint32_t LINKTYPE_ETHERNET = 1;
+constexpr uint32_t LINKTYPE_RAW = 101;
+constexpr uint32_t LINKTYPE_LOOP = 108;
+constexpr uint32_t LINKTYPE_LINUX_SLL = 113;
+constexpr uint32_t LINKTYPE_IPV4 = 228;
+constexpr uint32_t LINKTYPE_LINUX_SLL2 = 276;
+
+constexpr uint16_t ETHERTYPE_IPV4 = 0x0800;
+constexpr uint16_t ETHERTYPE_VLAN = 0x8100;
+constexpr uint16_t ETHERTYPE_QINQ = 0x88A8;
+constexpr std::size_t IP_MIN_HEADER_LEN = 20;
+constexpr std::size_t UDP_HEADER_LEN = 8;
+
+constexpr int64_t NS_PER_SEC = 1'000'000'000;
+
+auto fail(const std::string& what) -> std::runtime_error {
+    return std::runtime_error("pcap_source: " + what);
+}
+
+template <typename T>
+constexpr auto byteswap(T value) -> T {
+    if constexpr (sizeof(T) == sizeof(uint16_t)) {
+        return bswap_16(value);
+    } else if constexpr (sizeof(T) == sizeof(uint32_t)) {
+        return bswap_32(value);
+    } else {
+        return bswap_64(value);
+    }
+}
+
+template <typename T>
+auto read(const uint8_t* ptr, bool swap = false) -> T {
+    auto value = T{};
+    std::memcpy(&value, ptr, sizeof(value));
+    return swap ? byteswap(value) : value;
+}
+
+template <typename T>
+auto read_be(const uint8_t* ptr) -> T {
+    return read<T>(ptr, std::endian::native == std::endian::little);
+}
+
+// Timestamp in units of 10^-digits s, or 2^-digits s when binary is set
+auto to_ns(uint64_t value, uint8_t digits, bool binary) -> int64_t {
+    if (binary) {
+        auto shift = std::min<uint8_t>(digits, 63);
+        auto secs = value >> shift;
+        auto frac = value & ((uint64_t{1} << shift) - 1);
+        // Keep frac * 1e9 within 64 bits
+        if (shift > 30) {
+            frac >>= (shift - 30);
+            shift = 30;
+        }
+        return (static_cast<int64_t>(secs) * NS_PER_SEC) + static_cast<int64_t>((frac * NS_PER_SEC) >> shift);
+    }
+    auto scale = uint64_t{1};
+    for (auto i = std::min<uint8_t>(digits, 9); i < 9; ++i) {
+        scale *= 10;
+    }
+    if (digits <= 9) {
+        return static_cast<int64_t>(value * scale);
+    }
+    auto divisor = uint64_t{1};
+    for (auto i = uint8_t{9}; i < std::min<uint8_t>(digits, 19); ++i) {
+        divisor *= 10;
+    }
+    return static_cast<int64_t>(value / divisor);
+}
+
+} // namespace
+
+capture::capture(const std::string& filename, std::string_view ip_addr, uint16_t port) :
+  m_dst_port(port) {
+    if (!ip_addr.empty()) {
+        m_dst_addr = ntohl(inet_addr(std::string{ip_addr}.c_str()));
+    }
+    m_fd = open(filename.c_str(), O_RDONLY);
+    if (m_fd == -1) {
+        throw fail(filename + ": " + std::strerror(errno));
+    }
+    struct stat st{};
+    fstat(m_fd, &st);
+    m_size = static_cast<std::size_t>(st.st_size);
+    if (m_size < sizeof(uint32_t)) {
+        close(m_fd);
+        throw fail(filename + ": not a capture file");
+    }
+    auto map = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (map == MAP_FAILED) {
+        close(m_fd);
+        throw fail(filename + ": mmap: " + std::strerror(errno));
+    }
+    m_map = static_cast<uint8_t*>(map);
+    // The whole file is walked once to index it
+    madvise(m_map, m_size, MADV_SEQUENTIAL);
+    auto magic = read<uint32_t>(m_map);
+    if (magic == PCAPNG_SHB) {
+        index_pcapng();
+    } else if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS ||
+               magic == byteswap(PCAP_MAGIC_US) || magic == byteswap(PCAP_MAGIC_NS)) {
+        index_pcap();
+    } else {
+        munmap(m_map, m_size);
+        close(m_fd);
+        throw fail(filename + ": not a pcap or pcapng file");
+    }
+    madvise(m_map, m_size, MADV_NORMAL);
+}
+
+capture::~capture() {
+    munmap(m_map, m_size);
+    close(m_fd);
+}
+
+auto capture::index_pcap() -> void {
+    if (m_size < PCAP_HEADER_LEN) {
+        return;
+    }
+    auto magic = read<uint32_t>(m_map);
+    auto swap = (magic == byteswap(PCAP_MAGIC_US)) || (magic == byteswap(PCAP_MAGIC_NS));
+    auto nanos = (magic == PCAP_MAGIC_NS) || (magic == byteswap(PCAP_MAGIC_NS));
+    auto linktype = read<uint32_t>(m_map + 20, swap) & 0xFFFF;
+    auto offset = PCAP_HEADER_LEN;
+    while (offset + PCAP_RECORD_LEN <= m_size) {
+        auto rec = m_map + offset;
+        auto secs = read<uint32_t>(rec, swap);
+        auto frac = read<uint32_t>(rec + 4, swap);
+        auto caplen = std::size_t{read<uint32_t>(rec + 8, swap)};
+        offset += PCAP_RECORD_LEN;
+        if (offset + caplen > m_size) {
+            break;  // truncated capture
+        }
+        auto timestamp = (static_cast<int64_t>(secs) * NS_PER_SEC) + (nanos ? frac : int64_t{frac} * 1000);
+        add(offset, caplen, linktype, timestamp);
+        offset += caplen;
+    }
+}
+
+auto capture::index_pcapng() -> void {
+    struct interface {
+        uint32_t linktype;
+        uint32_t snaplen;
+        uint8_t tsresol;
+        bool binary;
+    };
+    auto interfaces = std::vector<interface>{};
+    auto swap = false;
+    auto offset = std::size_t{};
+    while (offset + 12 <= m_size) {
+        auto block = m_map + offset;
+        auto type = read<uint32_t>(block, swap);
+        if (type == PCAPNG_SHB) {
+            // Each section sets its own byte order and interfaces
+            auto order = read<uint32_t>(block + 8);
+            if (order != PCAPNG_BYTE_ORDER && order != byteswap(PCAPNG_BYTE_ORDER)) {
+                break;
+            }
+            swap = order != PCAPNG_BYTE_ORDER;
+            interfaces.clear();
+        }
+        auto length = std::size_t{read<uint32_t>(block + 4, swap)};
+        if (length < 12 || offset + length > m_size) {
+            break;  // corrupt or truncated
+        }
+        auto body = block + 8;
+        auto body_len = length - 12;
+        if (type == PCAPNG_IDB && body_len >= 8) {
+            auto iface = interface{read<uint16_t>(body, swap), read<uint32_t>(body + 4, swap), 6, false};
+            // Options: code, length, value padded to 32 bits
+            auto opt = std::size_t{8};
+            while (opt + 4 <= body_len) {
+                auto code = read<uint16_t>(body + opt, swap);
+                auto len = std::size_t{read<uint16_t>(body + opt + 2, swap)};
+                if (code == PCAPNG_OPT_END) {
+                    break;
+                }
+                if (code == PCAPNG_OPT_TSRESOL && len >= 1 && opt + 5 <= body_len) {
+                    iface.tsresol = body[opt + 4] & 0x7F;
+                    iface.binary = (body[opt + 4] & 0x80) != 0;
+                }
+                opt += 4 + ((len + 3) & ~std::size_t{3});
+            }
+            interfaces.push_back(iface);
+        } else if ((type == PCAPNG_EPB || type == PCAPNG_OPB) && body_len >= 20) {
+            // The obsolete packet block has a 16 bit interface id and drop count
+            auto id = type == PCAPNG_EPB ? read<uint32_t>(body, swap) : read<uint16_t>(body, swap);
+            auto ts = (uint64_t{read<uint32_t>(body + 4, swap)} << 32) | read<uint32_t>(body + 8, swap);
+            auto caplen = std::min<std::size_t>(read<uint32_t>(body + 12, swap), body_len - 20);
+            if (id < interfaces.size()) {
+                const auto& iface = interfaces.at(id);
+                add(offset + 28, caplen, iface.linktype, to_ns(ts, iface.tsresol, iface.binary));
+            }
+        } else if (type == PCAPNG_SPB && body_len >= 4 && !interfaces.empty()) {
+            const auto& iface = interfaces.front();
+            auto caplen = std::min<std::size_t>(read<uint32_t>(body, swap), body_len - 4);
+            if (iface.snaplen != 0) {
+                caplen = std::min<std::size_t>(caplen, iface.snaplen);
+            }
+            add(offset + 12, caplen, iface.linktype, 0);
+        }
+        offset += length;
+    }
+}
+
+auto capture::add(std::size_t offset, std::size_t caplen, uint32_t linktype, int64_t timestamp) -> void {
+    auto frame = m_map + offset;
+    auto ip_offset = std::size_t{};
+    auto ethertype = ETHERTYPE_IPV4;
+    switch (linktype) {
+        case LINKTYPE_ETHERNET:
+            ip_offset = 14;
+            if (caplen < ip_offset) {
+                return;
+            }
+            ethertype = read_be<uint16_t>(frame + 12);
+            while ((ethertype == ETHERTYPE_VLAN || ethertype == ETHERTYPE_QINQ) && caplen >= ip_offset + 4) {
+                ethertype = read_be<uint16_t>(frame + ip_offset + 2);
+                ip_offset += 4;
+            }
+            break;
+        case LINKTYPE_RAW:
+        case LINKTYPE_IPV4:
+            break;
+        case LINKTYPE_NULL:
+        case LINKTYPE_LOOP:
+            // Address family, 2 for IPv4 in either byte order
+            ip_offset = 4;
+            if (caplen < ip_offset || (read<uint32_t>(frame) != 2 && read<uint32_t>(frame) != 0x02000000)) {
+                return;
+            }
+            break;
+        case LINKTYPE_LINUX_SLL:
+            ip_offset = 16;
+            if (caplen < ip_offset) {
+                return;
+            }
+            ethertype = read_be<uint16_t>(frame + 14);
+            break;
+        case LINKTYPE_LINUX_SLL2:
+            ip_offset = 20;
+            if (caplen < ip_offset) {
+                return;
+            }
+            ethertype = read_be<uint16_t>(frame);
+            break;
+        default:
+            return;
+    }
+    if (ethertype != ETHERTYPE_IPV4 || caplen < ip_offset + IP_MIN_HEADER_LEN) {
+        return;
+    }
+    auto ip = frame + ip_offset;
+    auto ip_header_len = static_cast<std::size_t>(ip[0] & 0x0F) * 4;
+    if ((ip[0] >> 4) != 4 || ip[9] != IPPROTO_UDP || ip_header_len < IP_MIN_HEADER_LEN) {
+        return;
+    }
+    // More fragments or a non-zero fragment offset
+    if ((read_be<uint16_t>(ip + 6) & 0x3FFF) != 0) {
+        return;
+    }
+    if (caplen < ip_offset + ip_header_len + UDP_HEADER_LEN) {
+        return;
+    }
+    if (m_dst_addr != 0 && read_be<uint32_t>(ip + 16) != m_dst_addr) {
+        return;
+    }
+    auto udp = ip + ip_header_len;
+    if (m_dst_port != 0 && read_be<uint16_t>(udp + 2) != m_dst_port) {
+        return;
+    }
+    auto udp_len = std::size_t{read_be<uint16_t>(udp + 4)};
+    if (udp_len < UDP_HEADER_LEN) {
+        return;
+    }
+    auto payload_offset = ip_offset + ip_header_len + UDP_HEADER_LEN;
+    auto length = std::min(udp_len - UDP_HEADER_LEN, caplen - payload_offset);
+    m_records.push_back({offset + payload_offset, static_cast<uint32_t>(length), timestamp});
+}
+
+} // namespace pcapsrc
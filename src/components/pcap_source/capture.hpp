@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pcapsrc {
+
+// UDP payload of one captured datagram
+struct record {
+    std::size_t offset;  // into the mapped file
+    uint32_t length;
+    int64_t timestamp;   // capture time, ns since the epoch (0 if not recorded)
+};
+
+/*
+ * Memory-mapped pcap or pcapng capture, indexed once into the UDP payloads
+ * sent to ip_addr:port (an empty address or port 0 matches any). Ethernet
+ * (with VLAN tags), raw IP, Linux cooked (v1 and v2) and loopback link types
+ * are understood; IP fragments and non-IPv4 frames are skipped.
+ */
+class capture {
+public:
+    capture(const std::string& filename, std::string_view ip_addr, uint16_t port);
+    ~capture();
+
+    capture(const capture&) = delete;
+    capture& operator=(const capture&) = delete;
+
+    auto data() const -> const uint8_t* {
+        return m_map;
+    }
+
+    auto records() const -> const std::vector<record>& {
+        return m_records;
+    }
+
+private:
+    int m_fd{-1};
+    uint8_t* m_map{nullptr};
+    std::size_t m_size{};
+    uint32_t m_dst_addr{};
+    uint16_t m_dst_port{};
+    std::vector<record> m_records;
+
+    auto index_pcap() -> void;
+    auto index_pcapng() -> void;
+    auto add(std::size_t offset, std::size_t caplen, uint32_t linktype, int64_t timestamp) -> void;
+
+}; // class capture
+
+} // namespace pcapsrc
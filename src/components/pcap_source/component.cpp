@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "component.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+pcap_source::pcap_source() : composite::component("pcap_source") {
+    add_port(m_out_port.get());
+    add_property("filename", &m_filename);
+    add_property("ip_addr", &m_ip_addr);
+    add_property("port", &m_port);
+    add_property("msg_size", &m_msg_size);
+    add_property("num_msgs", &m_num_msgs);
+    add_property("pool_size", &m_pool_size);
+    add_property("replay", &m_replay);
+    add_property("rate", &m_rate);
+    add_property("loop", &m_loop);
+    add_property("packets_sent", &m_packets_sent);
+    add_property("laps", &m_laps);
+}
+
+auto pcap_source::initialize() -> void {
+    if (m_replay == "timed") {
+        m_mode = replay_mode::TIMED;
+    } else if (m_replay == "rate") {
+        if (m_rate == 0) {
+            throw std::runtime_error("pcap_source: replay 'rate' needs a non-zero rate");
+        }
+        m_mode = replay_mode::RATE;
+    } else {
+        m_mode = replay_mode::FAST;
+    }
+    m_num_msgs = std::max<uint32_t>(m_num_msgs, 1);
+    m_pool_size = std::max<uint32_t>(m_pool_size, 1);
+    m_capture = std::make_shared<const pcapsrc::capture>(m_filename, m_ip_addr, static_cast<uint16_t>(m_port));
+    m_pool = std::make_shared<pcapsrc::batch_pool>(m_capture, m_num_msgs, m_pool_size);
+    // A timed lap lasts the capture plus one average packet gap, so looping
+    // keeps the packet spacing across the wrap
+    const auto& records = m_capture->records();
+    if (records.size() > 1) {
+        auto span = records.back().timestamp - records.front().timestamp;
+        m_lap_duration = std::chrono::nanoseconds(span + (span / static_cast<int64_t>(records.size() - 1)));
+    }
+}
+
+auto pcap_source::start() -> void {
+    m_next = 0;
+    m_laps = 0;
+    m_start = clock::now();
+    composite::component::start();
+}
+
+auto pcap_source::due(std::size_t idx) const -> std::chrono::nanoseconds {
+    const auto& records = m_capture->records();
+    if (m_mode == replay_mode::RATE) {
+        auto count = (m_laps * records.size()) + idx;
+        return std::chrono::nanoseconds(static_cast<int64_t>((count * 1'000'000'000) / m_rate));
+    }
+    return std::chrono::nanoseconds(records.at(idx).timestamp - records.front().timestamp) +
+        (m_lap_duration * static_cast<int64_t>(m_laps));
+}
+
+auto pcap_source::process() -> composite::retval {
+    using enum composite::retval;
+    const auto& records = m_capture->records();
+    if (m_next == records.size()) {
+        if (!m_loop || records.empty()) {
+            return FINISH;
+        }
+        m_next = 0;
+        ++m_laps;
+    }
+    if (m_mode != replay_mode::FAST) {
+        // Sleep in slices of at most a second so stop requests are seen
+        auto due_at = m_start + due(m_next);
+        if (auto now = clock::now(); now < due_at) {
+            std::this_thread::sleep_until(std::min(due_at, now + std::chrono::seconds(1)));
+            return NO_YIELD;
+        }
+    }
+    // Everything that is due, up to num_msgs datagrams, as one batch of views
+    // into the capture
+    auto data = m_pool->acquire(std::chrono::milliseconds(100));
+    if (data == nullptr) {
+        // Every batch is still downstream
+        return NO_YIELD;
+    }
+    auto elapsed = clock::now() - m_start;
+    auto base = records.at(m_next).offset;
+    data->reset(m_capture->data() + base);
+    while (data->size() < m_num_msgs && m_next < records.size()) {
+        if (m_mode != replay_mode::FAST && due(m_next) > elapsed) {
+            break;
+        }
+        const auto& rec = records.at(m_next);
+        auto length = m_msg_size == 0 ? rec.length : std::min(rec.length, m_msg_size);
+        data->push_back(rec.offset - base, length, rec.timestamp);
+        ++m_next;
+    }
+    m_packets_sent += data->size();
+    // Captured time of the first datagram, if the capture recorded one
+    auto ns = data->timestamp(0) != 0 ? data->timestamp(0) :
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    auto ts = batch::to_timestamp<composite::timestamp>(ns);
+    m_out_port->send_data(m_pool->share(std::move(data)), ts);
+    return NO_YIELD;
+}
+
+extern "C" {
+    auto create() -> std::shared_ptr<composite::component> {
+        return std::make_shared<pcap_source>();
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include "batch_pool.hpp"
+#include "capture.hpp"
+
+#include <packet_batch.hpp>
+
+#include <chrono>
+#include <composite/component.hpp>
+#include <memory>
+#include <string>
+
+/*
+ * Replays the UDP payloads of a pcap/pcapng capture in the batches udp_source
+ * produces, as fast as possible, with the capture's own timing or at a fixed
+ * packet rate, optionally looping forever.
+ */
+class pcap_source : public composite::component {
+    using output_t = batch::packet_batch;
+    using output_port_t = composite::output_port<std::shared_ptr<output_t>>;
+    using clock = std::chrono::steady_clock;
+    static constexpr std::uint32_t NUM_MSGS{64};
+    static constexpr std::uint32_t POOL_SIZE{16};
+    enum class replay_mode {
+        FAST,
+        TIMED,
+        RATE
+    };
+public:
+    pcap_source();
+    ~pcap_source() override = default;
+    auto initialize() -> void override;
+    auto start() -> void override;
+    auto process() -> composite::retval override;
+
+private:
+    // Ports
+    std::unique_ptr<output_port_t> m_out_port{std::make_unique<output_port_t>("data_out")};
+
+    // Properties
+    std::string m_filename;
+    std::string m_ip_addr;
+    uint32_t m_port{};
+    uint32_t m_msg_size{};
+    uint32_t m_num_msgs{NUM_MSGS};
+    uint32_t m_pool_size{POOL_SIZE};
+    std::string m_replay{"fast"};
+    uint32_t m_rate{};
+    bool m_loop{false};
+    uint64_t m_packets_sent{};
+    uint64_t m_laps{};
+
+    // Members
+    std::shared_ptr<const pcapsrc::capture> m_capture;
+    std::shared_ptr<pcapsrc::batch_pool> m_pool;
+    replay_mode m_mode{replay_mode::FAST};
+    std::size_t m_next{};
+    std::chrono::nanoseconds m_lap_duration{};
+    clock::time_point m_start;
+
+    // Time after start at which a record of the current lap is due
+    auto due(std::size_t idx) const -> std::chrono::nanoseconds;
+
+}; // class pcap_source
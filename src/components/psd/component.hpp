@@ -20,20 +20,23 @@
 #include "work.hpp"
 
 #include <aligned_mem.hpp>
+#include <alloc_policy.hpp>
+#include <stream_context.hpp>
 #include <windows.hpp>
 
 #include <composite/component.hpp>
 #include <complex>
 #include <immintrin.h>
 #include <memory>
+#include <stdexcept>
 
 template <typename T>
 class psd : public composite::component {
     using fft_t = aligned::aligned_mem<std::complex<T>>;
     using psd_t = aligned::aligned_mem<T>;
     using window_t = aligned::aligned_mem<T>;
-    using input_port_t = composite::input_port<std::unique_ptr<fft_t>>;
-    using output_port_t = composite::output_port<std::unique_ptr<psd_t>>;
+    using input_port_t = composite::input_port<aligned::shared_mem<std::complex<T>>>;
+    using output_port_t = composite::output_port<aligned::shared_mem<T>>;
 public:
     psd() : composite::component("psd") {
         add_port(m_in_port.get());
@@ -41,6 +44,8 @@ public:
         add_property("window", &m_window_type);
         add_property("fft_size", &m_fft_size);
         add_property("sample_rate", &m_sample_rate);
+        add_property("memory", &m_memory);
+        add_property("numa_node", &m_numa_node);
     }
 
     ~psd() override = default;
@@ -60,8 +65,14 @@ public:
                 return val * val;
             }
         );
-        auto window_sum = std::accumulate(m_window->data(), m_window->data() + m_window->size(), T{});
-        m_work = std::make_unique<work<T>>(window_sum, m_sample_rate);
+        m_window_sum = std::accumulate(m_window->data(), m_window->data() + m_window->size(), T{});
+        m_work = std::make_unique<work<T>>(m_window_sum, m_sample_rate);
+        m_work_sample_rate = m_sample_rate;
+        auto policy = aligned::parse_alloc_policy(m_memory, m_numa_node);
+        if (!policy) {
+            throw std::runtime_error("psd: invalid memory " + m_memory + " or numa_node " + m_numa_node);
+        }
+        m_pool = &aligned::pool::get(*policy);
     }
 
     auto process() -> composite::retval override {
@@ -70,8 +81,21 @@ public:
         if (data == nullptr) {
             return NOOP;
         }
+        // Rescale only when the stream context actually changes
+        if (data->context() != m_context) {
+            m_context = data->context();
+            auto sample_rate = m_sample_rate;
+            if (m_context != nullptr && m_context->sample_rate) {
+                sample_rate = static_cast<T>(*m_context->sample_rate);
+            }
+            if (sample_rate != m_work_sample_rate) {
+                m_work = std::make_unique<work<T>>(m_window_sum, sample_rate);
+                m_work_sample_rate = sample_rate;
+            }
+        }
         // Perform PSD
-        auto psd = m_work->process(data.get());
+        auto psd = m_work->process(data.get(), *m_pool);
+        psd->set_context(m_context);
         std::transform(psd->data(), psd->data() + psd->size(), psd->data(), [](T val) {
             if (val > T{0}) {
                 if constexpr (std::is_same_v<T, float>) {
@@ -98,9 +122,15 @@ private:
     std::string m_window_type;
     uint32_t m_fft_size{1024};
     T m_sample_rate{1};
+    std::string m_memory{"default"};
+    std::string m_numa_node;
 
     // Members
     std::unique_ptr<window_t> m_window;
     std::unique_ptr<work<T>> m_work;
+    T m_window_sum{};
+    T m_work_sample_rate{};
+    metadata::context_ptr m_context;
+    aligned::pool* m_pool{&aligned::pool::global()};
 
 }; // class psd
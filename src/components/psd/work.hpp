@@ -40,8 +40,8 @@ public:
         m_imag_idx_512i = _mm512_set_epi32(31,29,27,25,23,21,19,17,15,13,11,9,7,5,3,1);
     }
 
-    auto process(aligned::aligned_mem<std::complex<float>>* data) -> std::unique_ptr<aligned::aligned_mem<float>> {
-        auto psd = aligned::make_aligned<float>(data->alignment(), data->size());
+    auto process(const aligned::aligned_mem<std::complex<float>>* data, aligned::pool& pool) -> std::unique_ptr<aligned::aligned_mem<float>> {
+        auto psd = aligned::make_aligned<float>(data->alignment(), data->size(), pool);
         for (auto i=0u; i < data->size(); i += 16) {
             // Load real and imag parts separately
             auto real_m512 = _mm512_i32gather_ps(m_real_idx_512i, data->data() + i, 4);
@@ -92,8 +92,8 @@ public:
         m_imag_idx_512i = _mm512_set_epi64(15,13,11,9,7,5,3,1);
     }
 
-    auto process(aligned::aligned_mem<std::complex<double>>* data) -> std::unique_ptr<aligned::aligned_mem<double>> {
-        auto psd = aligned::make_aligned<double>(data->alignment(), data->size());
+    auto process(const aligned::aligned_mem<std::complex<double>>* data, aligned::pool& pool) -> std::unique_ptr<aligned::aligned_mem<double>> {
+        auto psd = aligned::make_aligned<double>(data->alignment(), data->size(), pool);
         for (auto i=0u; i < data->size(); i += 8) {
             // Load real and imag parts separately
             auto real_m512 = _mm512_i64gather_pd(m_real_idx_512i, data->data() + i, 8);
@@ -17,97 +17,209 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 
+#include "condition.hpp"
 #include "convert.hpp"
+#include "reorder.hpp"
 
 #include <aligned_mem.hpp>
+#include <alloc_policy.hpp>
 #include <overlay.hpp>
+#include <packet_batch.hpp>
+#include <sequence.hpp>
+#include <stream_context.hpp>
+#include <windows.hpp>
 
 #include <algorithm>
+#include <array>
 #include <composite/component.hpp>
+#include <cmath>
 #include <complex>
 #include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 template <typename T>
 class stov : public composite::component {
-    using input_t = std::vector<uint8_t>;
+    using input_t = batch::packet_batch;
     using input_port_t = composite::input_port<std::shared_ptr<input_t>>;
     using output_t = aligned::aligned_mem<T>;
-    using output_port_t = composite::output_port<std::unique_ptr<output_t>>;
+    using output_port_t = composite::output_port<aligned::shared_mem<T>>;
+    using scalar_t = std::conditional_t<std::is_same_v<T, float> || std::is_same_v<T, std::complex<float>>, float, double>;
+    using load_fn = avx::reg_t<scalar_t> (*)(const uint8_t*, bool);
+    using window_t = aligned::aligned_mem<scalar_t>;
+    // Output elements written per conversion kernel call (one 512 bit register)
+    static constexpr std::size_t LANES = 64 / sizeof(scalar_t);
+    static constexpr std::size_t SCALARS = sizeof(T) / sizeof(scalar_t);
+    static constexpr std::size_t STEP = LANES / SCALARS;
+    static constexpr uint32_t REORDER_BATCHES{4};
 public:
     stov() : composite::component("stov") {
         add_port(m_in_port.get());
         add_port(m_out_port.get());
         add_property("output_size", &m_output_size);
         add_property("transport", &m_transport);
+        add_property("sample_format", &m_sample_format);
         add_property("byteswap", &m_byteswap);
-        add_property("msg_size", &m_msg_size);
+        add_property("overlap", &m_overlap);
+        add_property("sample_rate", &m_sample_rate);
+        add_property("scale", &m_scale);
+        add_property("dc_alpha", &m_dc_alpha);
+        add_property("window", &m_window_type);
+        add_property("streams", &m_streams_filter);
+        add_property("filtered_packets", &m_filtered_packets);
+        add_property("reorder_depth", &m_reorder_depth);
+        add_property("reorder_batches", &m_reorder_batches);
+        add_property("gap_policy", &m_gap_policy);
+        add_property("gap_packets", &m_gap_packets);
+        add_property("late_packets", &m_late_packets);
+        add_property("seq_gaps", &m_seq_gaps);
+        add_property("seq_lost", &m_seq_lost);
+        add_property("seq_duplicates", &m_seq_duplicates);
+        add_property("seq_reordered", &m_seq_reordered);
+        add_property("num_streams", &m_num_streams);
+        add_property("context_changes", &m_context_changes);
+        add_property("memory", &m_memory);
+        add_property("numa_node", &m_numa_node);
     }
 
     ~stov() override = default;
 
+    auto initialize() -> void override {
+        auto kind = overlay::parse_transport(m_transport);
+        m_kind = kind;
+        m_numbering = kind ? overlay::sequence_numbering(*kind) : sequence::numbering{0, 0};
+        m_seq = sequence::stream_trackers(m_numbering);
+        auto format = parse_sample_format(m_sample_format);
+        m_load = format ? payload_loader<scalar_t>(*format) : nullptr;
+        m_step_bytes = format ? LANES * sample_bits(*format) / 8 : 0;
+        // Frames are filled a register at a time
+        if (m_output_size == 0 || m_output_size % STEP != 0) {
+            throw std::runtime_error("stov: output_size must be a non-zero multiple of " + std::to_string(STEP));
+        }
+        // Overlap in whole kernel steps so conversion stays register aligned,
+        // leaving a hop of at least one step
+        auto overlap = std::clamp(m_overlap, 0.0F, 1.0F) * static_cast<float>(m_output_size);
+        m_overlap_size = static_cast<uint32_t>(overlap / STEP) * STEP;
+        if (m_overlap_size >= m_output_size) {
+            m_overlap_size = m_output_size >= STEP ? m_output_size - STEP : 0;
+        }
+        constexpr auto complex = SCALARS == 2;
+        if (m_window_type == "BLACKMAN_HARRIS") {
+            m_window = windows::blackman_harris<scalar_t>(m_output_size, complex);
+        } else if (m_window_type == "HAMMING") {
+            m_window = windows::hamming<scalar_t>(m_output_size, complex);
+        }
+        m_filter = parse_stream_ids(m_streams_filter);
+        m_accumulators.clear();
+        m_held.clear();
+        if (m_gap_policy == "drop") {
+            m_gap_mode = gap_mode::DROP;
+        } else if (m_gap_policy == "mark") {
+            m_gap_mode = gap_mode::MARK;
+        } else {
+            m_gap_mode = gap_mode::ZERO;
+        }
+        auto policy = aligned::parse_alloc_policy(m_memory, m_numa_node);
+        if (!policy) {
+            throw std::runtime_error("stov: invalid memory " + m_memory + " or numa_node " + m_numa_node);
+        }
+        m_pool = &aligned::pool::get(*policy);
+    }
+
     auto process() -> composite::retval override {
         using enum composite::retval;
         auto [data, _] = m_in_port->get_data();
         if (data == nullptr) {
+            // The input went quiet: give up open gaps rather than sit on
+            // batches the source may be waiting to reuse
+            if (!m_held.empty()) {
+                flush_reorder();
+            }
             return NORMAL;
         }
-        for (auto idx = size_t{}; idx < data->size(); idx += m_msg_size) {
-            auto payload = std::span<const std::complex<int16_t>>{};
-            auto ts = composite::timestamp{};
-            if (m_transport == "sdds") {
-                auto packet = overlay::sdds::overlay({data->data() + idx, m_msg_size});
-                // TODO - validations regarding parity and ttv
-                ts = composite::timestamp{packet.secs(), packet.psecs()};
-                payload = packet.payload<std::complex<int16_t>>();
-            } else if (m_transport == "vita49") {
-                auto packet = overlay::v49::overlay({data->data() + idx, m_msg_size});
-                if (auto& header = packet.header(); !overlay::v49::is_data(header)) {
-                    continue;
-                }
-                if (auto int_ts = packet.integer_timestamp()) {
-                    ts.seconds = int_ts.value();
-                }
-                if (auto frac_ts = packet.fractional_timestamp()) {
-                    ts.picoseconds = frac_ts.value();
-                }
-                payload = packet.payload<std::complex<int16_t>>();
+        if (!m_kind || m_load == nullptr) {
+            return NO_YIELD;
+        }
+        // TODO - SDDS ttv validation; parity frames are skipped by the parser
+        const auto& table = overlay::descriptors(*data, *m_kind);
+        auto kinds = table.kinds();
+        for (auto idx = size_t{}; idx < table.size(); ++idx) {
+            auto stream = table.stream_ids()[idx];
+            if (!m_filter.empty() && !std::binary_search(m_filter.begin(), m_filter.end(), stream)) {
+                ++m_filtered_packets;
+                continue;
             }
-            auto i=0u;
-            auto stride = size_t{4};
-            if constexpr (std::is_same_v<T, float> || std::is_same_v<T, std::complex<float>>) {
-                stride = 8;
+            if (kinds[idx] == overlay::packet_kind::CONTEXT) {
+                auto context = m_contexts.current(stream);
+                overlay::v49::parse_context(table.payload<uint8_t>(idx), context);
+                m_contexts.update(context);
+                continue;
             }
-            for (; i < payload.size(); i += stride) {
-                if (m_output_buf == nullptr) {
-                    m_output_buf = aligned::make_aligned<typename output_t::value_type>(64, m_output_size);
-                    m_output_ts = ts;
-                }
-                if constexpr (std::is_same_v<T, float> || std::is_same_v<T, std::complex<float>>) {
-                    convert(
-                        reinterpret_cast<const int16_t*>(payload.data() + i),
-                        reinterpret_cast<float*>(m_output_buf->data() + m_output_idx),
-                        m_byteswap
-                    );
-                } else { // double or std::complex<double>
-                    convert(
-                        reinterpret_cast<const int16_t*>(payload.data() + i),
-                        reinterpret_cast<double*>(m_output_buf->data() + m_output_idx),
-                        m_byteswap
-                    );
-                }
-                m_output_idx += stride;
-                if (m_output_idx == m_output_size) {
-                    m_out_port->send_data(std::move(m_output_buf), m_output_ts);
-                    m_output_buf.reset();
-                    m_output_idx = 0;
-                }
+            if (kinds[idx] != overlay::packet_kind::DATA) {
+                continue;
+            }
+            if (m_numbering.bits > 0) {
+                m_seq.update(stream, table.sequences()[idx]);
+            }
+            auto& acc = accumulator(stream);
+            auto in = packet{table.payload<uint8_t>(idx), table.seconds()[idx], table.picoseconds()[idx]};
+            if (acc.reorder) {
+                acc.reorder->push(
+                    table.sequences()[idx],
+                    in,
+                    [&](const packet& next) { convert_packet(acc, stream, next); },
+                    [&](uint32_t missing) { fill_gap(acc, stream, missing); }
+                );
+            } else {
+                convert_packet(acc, stream, in);
             }
         }
+        hold_batch(data);
+        update_seq_counters();
+        m_context_changes = m_contexts.changes();
         return NO_YIELD;
     }
 
 private:
+    enum class gap_mode {
+        ZERO,
+        DROP,
+        MARK
+    };
+
+    // Payload and time of one data packet
+    struct packet {
+        std::span<const uint8_t> payload;
+        uint32_t seconds{};
+        uint64_t picoseconds{};
+    };
+
+    // Frame being filled for one stream, with the conditioning state that follows it
+    struct stream_accumulator {
+        std::unique_ptr<output_t> frame;
+        uint32_t idx{};
+        uint32_t seconds{};
+        uint64_t picoseconds{};
+        conditioner<scalar_t> conditioning;
+        std::unique_ptr<window_t> tail;
+        std::optional<reorder_buffer<packet>> reorder;
+        packet last;
+        std::array<uint8_t, 64> carry{};
+        std::size_t carried{};
+        bool invalid{false};
+        // Samples since the packet at the anchor time, to measure the rate
+        bool anchored{false};
+        uint32_t anchor_seconds{};
+        uint64_t anchor_picoseconds{};
+        double anchor_samples{};
+        double measured_rate{};
+    };
+
     // Ports
     std::unique_ptr<input_port_t> m_in_port{std::make_unique<input_port_t>("data_in")};
     std::unique_ptr<output_port_t> m_out_port{std::make_unique<output_port_t>("data_out")};
@@ -115,12 +227,294 @@ private:
     // Properties
     uint32_t m_output_size{};
     std::string m_transport;
+    std::string m_sample_format{"int16"};
     bool m_byteswap{true};
-    uint32_t m_msg_size{};
+    float m_overlap{};
+    float m_sample_rate{};
+    float m_scale{1};
+    float m_dc_alpha{};
+    std::string m_window_type;
+    std::string m_streams_filter;
+    uint64_t m_filtered_packets{};
+    uint32_t m_reorder_depth{};
+    uint32_t m_reorder_batches{REORDER_BATCHES};
+    std::string m_gap_policy{"zero"};
+    uint64_t m_gap_packets{};
+    uint64_t m_late_packets{};
+    uint64_t m_seq_gaps{};
+    uint64_t m_seq_lost{};
+    uint64_t m_seq_duplicates{};
+    uint64_t m_seq_reordered{};
+    uint32_t m_num_streams{};
+    uint64_t m_context_changes{};
+    std::string m_memory{"default"};
+    std::string m_numa_node;
 
     // Members
-    std::unique_ptr<output_t> m_output_buf;
-    uint32_t m_output_idx{};
-    typename output_port_t::timestamp_type m_output_ts;
+    std::unordered_map<uint32_t, stream_accumulator> m_accumulators;
+    std::vector<uint32_t> m_filter;
+    gap_mode m_gap_mode{gap_mode::ZERO};
+    std::vector<std::shared_ptr<input_t>> m_held;
+    uint32_t m_overlap_size{};
+    std::optional<overlay::transport> m_kind;
+    sequence::numbering m_numbering{0, 0};
+    load_fn m_load{nullptr};
+    std::unique_ptr<window_t> m_window;
+    std::size_t m_step_bytes{};
+    sequence::stream_trackers m_seq;
+    metadata::context_cache m_contexts;
+    aligned::pool* m_pool{&aligned::pool::global()};
+
+    auto accumulator(uint32_t stream) -> stream_accumulator& {
+        auto [found, added] = m_accumulators.try_emplace(stream);
+        auto& acc = found->second;
+        if (added) {
+            // Conditioning fused into the conversion loop
+            acc.conditioning = conditioner<scalar_t>(m_scale, m_dc_alpha);
+            // Overlapped samples are kept unwindowed to be windowed again at their new position
+            if (m_window && m_overlap_size > 0) {
+                acc.tail = aligned::make_aligned<scalar_t>(64, m_overlap_size * SCALARS, *m_pool);
+            }
+            if (m_reorder_depth > 0 && m_numbering.bits > 0) {
+                acc.reorder.emplace(m_numbering, m_reorder_depth);
+            }
+        }
+        return acc;
+    }
+
+    /*
+     * Converts a packet a kernel step at a time. Payloads need not be whole
+     * steps (e.g. packed12 in 1024 bytes): the bytes left over are carried
+     * and completed by the start of the stream's next packet, so the samples
+     * stay contiguous across packets.
+     */
+    auto convert_packet(stream_accumulator& acc, uint32_t stream, const packet& in) -> void {
+        measure_rate(acc, in);
+        auto payload = in.payload;
+        if (acc.carried > 0) {
+            auto needed = m_step_bytes - acc.carried;
+            auto taken = std::min(needed, payload.size());
+            std::copy_n(payload.begin(), taken, acc.carry.begin() + acc.carried);
+            acc.carried += taken;
+            payload = payload.subspan(taken);
+            if (acc.carried < m_step_bytes) {
+                acc.last = in;
+                return;
+            }
+            // Stamped as part of the packet it started in
+            push(acc, stream, m_load(acc.carry.data(), m_byteswap));
+            acc.carried = 0;
+        }
+        acc.last = in;
+        auto offset = size_t{};
+        for (; offset + m_step_bytes <= payload.size(); offset += m_step_bytes) {
+            push(acc, stream, m_load(payload.data() + offset, m_byteswap));
+        }
+        acc.carried = payload.size() - offset;
+        std::copy(payload.begin() + offset, payload.end(), acc.carry.begin());
+    }
+
+    /*
+     * Estimates the stream's sample rate from packet times: the samples
+     * between the anchor packet and this one over the time between their
+     * stamps. Gaps move the anchor, as the missing samples are not counted.
+     */
+    auto measure_rate(stream_accumulator& acc, const packet& in) -> void {
+        auto samples = static_cast<double>(in.payload.size()) * STEP / static_cast<double>(m_step_bytes);
+        if (!acc.anchored) {
+            acc.anchored = true;
+            acc.anchor_seconds = in.seconds;
+            acc.anchor_picoseconds = in.picoseconds;
+            acc.anchor_samples = samples;
+            return;
+        }
+        auto elapsed = (static_cast<double>(in.seconds) - acc.anchor_seconds)
+                     + (static_cast<double>(in.picoseconds) - static_cast<double>(acc.anchor_picoseconds)) * 1e-12;
+        if (elapsed > 0) {
+            acc.measured_rate = acc.anchor_samples / elapsed;
+        }
+        acc.anchor_samples += samples;
+    }
+
+    // Conditions one register of samples into the stream's frame
+    auto push(stream_accumulator& acc, uint32_t stream, avx::reg_t<scalar_t> values) -> void {
+        if (acc.frame == nullptr) {
+            acc.frame = aligned::make_aligned<typename output_t::value_type>(64, m_output_size, *m_pool);
+            acc.frame->set_context(m_contexts.get_or_add(stream));
+            acc.seconds = acc.last.seconds;
+            acc.picoseconds = acc.last.picoseconds;
+        }
+        if (acc.invalid) {
+            acc.frame->set_valid(false);
+            acc.invalid = false;
+        }
+        if (acc.conditioning.active()) {
+            values = acc.conditioning.apply(values);
+        }
+        auto pos = acc.idx * SCALARS;
+        auto hop = (m_output_size - m_overlap_size) * SCALARS;
+        if (acc.tail && pos >= hop) {
+            conditioner<scalar_t>::store(acc.tail->data() + pos - hop, values);
+        }
+        if (m_window) {
+            values = conditioner<scalar_t>::window(values, m_window->data() + pos);
+        }
+        conditioner<scalar_t>::store(reinterpret_cast<scalar_t*>(acc.frame->data()) + pos, values);
+        acc.idx += STEP;
+        if (acc.idx == m_output_size) {
+            send_frame(acc);
+        }
+    }
+
+    /*
+     * Applies the gap policy for packets given up as lost. Zero fill stands
+     * in packets the size of the last one, up to a frame's worth; a longer
+     * gap drops the partial frame as the samples around it cannot be lined
+     * up any more. Whatever the policy, the part of a step the missing bytes
+     * leave over is carried as zeros (in place of any bytes carried before
+     * the gap), so later packets keep their byte phase.
+     */
+    auto fill_gap(stream_accumulator& acc, uint32_t stream, uint32_t missing) -> void {
+        m_gap_packets += missing;
+        acc.anchored = false;
+        auto bytes = acc.carried + std::size_t{missing} * acc.last.payload.size();
+        auto registers = bytes / m_step_bytes;
+        acc.carried = bytes % m_step_bytes;
+        std::fill_n(acc.carry.begin(), acc.carried, uint8_t{});
+        auto mode = m_gap_mode;
+        if (mode == gap_mode::ZERO && registers > m_output_size / STEP) {
+            mode = gap_mode::DROP;
+        }
+        switch (mode) {
+            case gap_mode::ZERO:
+                for (auto count = size_t{}; count < registers; ++count) {
+                    push(acc, stream, avx::reg_t<scalar_t>{});
+                }
+                break;
+            case gap_mode::DROP:
+                acc.frame.reset();
+                acc.idx = 0;
+                break;
+            case gap_mode::MARK:
+                acc.invalid = true;
+                break;
+        }
+    }
+
+    /*
+     * Keeps the batch alive while any stream holds packets from it. Held
+     * batches are not returned to the source's pool, and a stream that stops
+     * with packets held would pin every later one, so after reorder_batches
+     * batches (counted apart from reorder_depth, which is in packets) the
+     * open gaps are given up.
+     */
+    auto hold_batch(const std::shared_ptr<input_t>& data) -> void {
+        auto pending = false;
+        for (auto& [stream, acc] : m_accumulators) {
+            if (acc.reorder) {
+                pending = pending || acc.reorder->pending() > 0;
+            }
+        }
+        if (!pending) {
+            m_held.clear();
+            return;
+        }
+        m_held.push_back(data);
+        if (m_held.size() < std::max(m_reorder_batches, uint32_t{1})) {
+            return;
+        }
+        flush_reorder();
+    }
+
+    // Converts whatever the reorder buffers hold, filling the gaps, and lets the held batches go
+    auto flush_reorder() -> void {
+        for (auto& [stream, acc] : m_accumulators) {
+            if (acc.reorder) {
+                acc.reorder->flush(
+                    [&](const packet& next) { convert_packet(acc, stream, next); },
+                    [&](uint32_t missing) { fill_gap(acc, stream, missing); }
+                );
+            }
+        }
+        m_held.clear();
+    }
+
+    /*
+     * Sends the stream's full frame. With overlap, the next frame starts with
+     * the last m_overlap_size samples of this one, copied once (from the
+     * unwindowed tail, windowed for their new position, when stov applies
+     * the window). It is stamped a hop later by the stream's sample rate:
+     * from its context, else the sample_rate property, else as measured from
+     * packet times. Until some rate is known there is no overlap, and the
+     * next frame is stamped by the packet it starts in like any other.
+     */
+    auto send_frame(stream_accumulator& acc) -> void {
+        auto sample_rate = double{m_sample_rate};
+        if (const auto& context = acc.frame->context(); context != nullptr && context->sample_rate) {
+            sample_rate = *context->sample_rate;
+        }
+        if (sample_rate <= 0) {
+            sample_rate = acc.measured_rate;
+        }
+        auto next = std::unique_ptr<output_t>{};
+        auto hop = m_output_size - m_overlap_size;
+        if (m_overlap_size > 0 && sample_rate > 0) {
+            next = aligned::make_aligned<typename output_t::value_type>(64, m_output_size, *m_pool);
+            if (acc.tail) {
+                auto dst = reinterpret_cast<scalar_t*>(next->data());
+                for (auto pos = size_t{}; pos < acc.tail->size(); pos += LANES) {
+                    auto values = conditioner<scalar_t>::load(acc.tail->data() + pos);
+                    conditioner<scalar_t>::store(dst + pos, conditioner<scalar_t>::window(values, m_window->data() + pos));
+                }
+            } else {
+                std::copy(acc.frame->data() + hop, acc.frame->data() + m_output_size, next->data());
+            }
+            next->set_context(acc.frame->context());
+        }
+        m_out_port->send_data(
+            std::move(acc.frame),
+            typename output_port_t::timestamp_type{acc.seconds, acc.picoseconds}
+        );
+        acc.frame = std::move(next);
+        acc.idx = acc.frame != nullptr ? m_overlap_size : 0;
+        if (acc.frame == nullptr) {
+            return;
+        }
+        constexpr auto PS_PER_SEC = uint64_t{1'000'000'000'000};
+        auto picoseconds = acc.picoseconds + static_cast<uint64_t>(std::llround(hop * 1e12 / sample_rate));
+        acc.seconds += static_cast<uint32_t>(picoseconds / PS_PER_SEC);
+        acc.picoseconds = picoseconds % PS_PER_SEC;
+    }
+
+    // Sorted stream IDs from a comma-separated list (decimal or 0x hex)
+    static auto parse_stream_ids(const std::string& list) -> std::vector<uint32_t> {
+        auto ids = std::vector<uint32_t>{};
+        auto start = std::size_t{};
+        while (start < list.size()) {
+            auto end = std::min(list.find(',', start), list.size());
+            auto item = list.substr(start, end - start);
+            if (item.find_first_not_of(' ') != std::string::npos) {
+                ids.push_back(static_cast<uint32_t>(std::stoul(item, nullptr, 0)));
+            }
+            start = end + 1;
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    auto update_seq_counters() -> void {
+        auto totals = m_seq.totals();
+        m_seq_gaps = totals.gaps;
+        m_seq_lost = totals.lost;
+        m_seq_duplicates = totals.duplicates;
+        m_seq_reordered = totals.reordered;
+        m_num_streams = static_cast<uint32_t>(m_seq.streams().size());
+        m_late_packets = 0;
+        for (const auto& [_, acc] : m_accumulators) {
+            if (acc.reorder) {
+                m_late_packets += acc.reorder->late();
+            }
+        }
+    }
 
 }; // class stov
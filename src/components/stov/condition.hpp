@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <immintrin.h>
+
+/*
+ * Signal conditioning applied to each converted register before it is
+ * stored, so it costs no extra pass over the frame: gain, running DC
+ * removal and the analysis window. The DC estimate is a one-pole average
+ * per lane; for complex output the lanes alternate I and Q, so each is
+ * tracked on its own.
+ */
+template <typename T>
+class conditioner {};
+
+template <>
+class conditioner<float> {
+public:
+    conditioner(float scale=1, float dc_alpha=0) :
+      m_scale(_mm512_set1_ps(scale)),
+      m_alpha(_mm512_set1_ps(dc_alpha)),
+      m_dc(_mm512_setzero_ps()),
+      m_scaling(scale != 1),
+      m_dc_removal(dc_alpha > 0) {}
+
+    auto active() const -> bool {
+        return m_scaling || m_dc_removal;
+    }
+
+    auto apply(__m512 values) -> __m512 {
+        if (m_scaling) {
+            values = _mm512_mul_ps(values, m_scale);
+        }
+        if (m_dc_removal) {
+            // Move the estimate alpha of the way to the new values, then remove it
+            m_dc = _mm512_fmadd_ps(m_alpha, _mm512_sub_ps(values, m_dc), m_dc);
+            values = _mm512_sub_ps(values, m_dc);
+        }
+        return values;
+    }
+
+    static auto window(__m512 values, const float* window) -> __m512 {
+        return _mm512_mul_ps(values, _mm512_load_ps(window));
+    }
+
+    static auto load(const float* src) -> __m512 {
+        return _mm512_load_ps(src);
+    }
+
+    static auto store(float* dst, __m512 values) -> void {
+        _mm512_store_ps(dst, values);
+    }
+
+private:
+    __m512 m_scale;
+    __m512 m_alpha;
+    __m512 m_dc;
+    bool m_scaling;
+    bool m_dc_removal;
+
+}; // class conditioner<float>
+
+template <>
+class conditioner<double> {
+public:
+    conditioner(double scale=1, double dc_alpha=0) :
+      m_scale(_mm512_set1_pd(scale)),
+      m_alpha(_mm512_set1_pd(dc_alpha)),
+      m_dc(_mm512_setzero_pd()),
+      m_scaling(scale != 1),
+      m_dc_removal(dc_alpha > 0) {}
+
+    auto active() const -> bool {
+        return m_scaling || m_dc_removal;
+    }
+
+    auto apply(__m512d values) -> __m512d {
+        if (m_scaling) {
+            values = _mm512_mul_pd(values, m_scale);
+        }
+        if (m_dc_removal) {
+            // Move the estimate alpha of the way to the new values, then remove it
+            m_dc = _mm512_fmadd_pd(m_alpha, _mm512_sub_pd(values, m_dc), m_dc);
+            values = _mm512_sub_pd(values, m_dc);
+        }
+        return values;
+    }
+
+    static auto window(__m512d values, const double* window) -> __m512d {
+        return _mm512_mul_pd(values, _mm512_load_pd(window));
+    }
+
+    static auto load(const double* src) -> __m512d {
+        return _mm512_load_pd(src);
+    }
+
+    static auto store(double* dst, __m512d values) -> void {
+        _mm512_store_pd(dst, values);
+    }
+
+private:
+    __m512d m_scale;
+    __m512d m_alpha;
+    __m512d m_dc;
+    bool m_scaling;
+    bool m_dc_removal;
+
+}; // class conditioner<double>
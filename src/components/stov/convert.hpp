@@ -22,16 +22,20 @@
 #include <concepts>
 #include <cstdint>
 #include <immintrin.h>
+#include <optional>
+#include <string_view>
 
 namespace avx {
 
 template <typename T>
 constexpr bool avxable_ps =
+    std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t> ||
     std::is_same_v<T, int16_t> || std::is_same_v<T, uint16_t> ||
     std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t>;
 
 template <typename T>
 constexpr bool avxable_pd =
+    std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t> ||
     std::is_same_v<T, int16_t> || std::is_same_v<T, uint16_t> ||
     std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t> ||
     std::is_same_v<T, int64_t> || std::is_same_v<T, uint64_t>;
@@ -68,7 +72,11 @@ inline auto cvt_64(const T* data, bool byteswap) -> __m512i {
     auto retval = __m512i{};
     // Load payload (type T))
     // Up-convert based on incoming type to 64-bit variant (signed or unsigned)
-    if constexpr (std::is_same_v<T, uint16_t>) {
+    if constexpr (std::is_same_v<T, uint8_t>) {
+        retval = _mm512_cvtepu8_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data)));
+    } else if constexpr (std::is_same_v<T, int8_t>) {
+        retval = _mm512_cvtepi8_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data)));
+    } else if constexpr (std::is_same_v<T, uint16_t>) {
         auto loaded = _mm_loadu_epi16(data);
         if (byteswap) {
             loaded = _mm_shuffle_epi8(loaded, swap::shuffle_u16_8);
@@ -107,7 +115,11 @@ inline auto cvt_32(const T* data, bool byteswap) -> __m512i {
     auto retval = __m512i{};
     // Load payload (type T))
     // Up-convert based on incoming type to 32-bit variant (signed or unsigned)
-    if constexpr (std::is_same_v<T, uint16_t>) {
+    if constexpr (std::is_same_v<T, uint8_t>) {
+        retval = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+    } else if constexpr (std::is_same_v<T, int8_t>) {
+        retval = _mm512_cvtepi8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+    } else if constexpr (std::is_same_v<T, uint16_t>) {
         auto loaded = _mm256_loadu_epi16(data);
         if (byteswap) {
             loaded = _mm256_shuffle_epi8(loaded, swap::shuffle_u16_16);
@@ -128,34 +140,222 @@ inline auto cvt_32(const T* data, bool byteswap) -> __m512i {
     return retval;
 }
 
+/*
+ * Packed 12 bit signed samples, two in every three bytes. Each 128 bit lane
+ * takes 12 bytes and gathers every sample into a 16 bit lane so that an
+ * arithmetic right shift by 4 leaves it sign extended: the shuffle places the
+ * sample's two bytes, the variable left shift lines the sample up with the
+ * top of the lane. Big-endian packing (byteswap) has the first sample in the
+ * high bits of the first byte pair, little-endian in the low bits.
+ */
+namespace packed12 {
+
+const __m128i shuffle_be = _mm_set_epi8(10,11,9,10,7,8,6,7,4,5,3,4,1,2,0,1);
+const __m128i shuffle_le = _mm_set_epi8(11,10,10,9,8,7,7,6,5,4,4,3,2,1,1,0);
+const __m128i shift_be = _mm_set_epi16(4,0,4,0,4,0,4,0);
+const __m128i shift_le = _mm_set_epi16(0,4,0,4,0,4,0,4);
+
+inline auto unpack(__m128i packed, bool big_endian) -> __m128i {
+    auto samples = _mm_shuffle_epi8(packed, big_endian ? shuffle_be : shuffle_le);
+    samples = _mm_sllv_epi16(samples, big_endian ? shift_be : shift_le);
+    return _mm_srai_epi16(samples, 4);
+}
+
+// 8 samples from 12 bytes, without reading past them
+inline auto cvt_16x8(const uint8_t* data, bool big_endian) -> __m128i {
+    return unpack(_mm_maskz_loadu_epi8(0x0FFF, data), big_endian);
+}
+
+// 16 samples from 24 bytes, without reading past them
+inline auto cvt_16x16(const uint8_t* data, bool big_endian) -> __m256i {
+    return _mm256_set_m128i(cvt_16x8(data + 12, big_endian), cvt_16x8(data, big_endian));
+}
+
+} // namespace packed12
+
 } // namespace avx
 
 template <typename T>
-auto convert(const T* data, float* dst, bool byteswap=false) -> void {
+auto load_ps(const T* data, bool byteswap=false) -> __m512 {
     // Load and convert
     auto data_m512i = avx::cvt_32(data, byteswap);
-    // Convert u/int64 to floats
-    auto payload_m512 = __m512{};
+    // Convert u/int32 to floats
     if constexpr (std::is_signed_v<T>) {
-        payload_m512 = _mm512_cvtepi32_ps(data_m512i);
+        return _mm512_cvtepi32_ps(data_m512i);
     } else {
-        payload_m512 = _mm512_cvtepu32_ps(data_m512i);
+        return _mm512_cvtepu32_ps(data_m512i);
     }
-    // Stored result into dst
-    _mm512_store_ps(dst, payload_m512);
 }
 
 template <typename T>
-auto convert(const T* data, double* dst, bool byteswap=false) -> void {
+auto load_pd(const T* data, bool byteswap=false) -> __m512d {
     // Load and convert
     auto data_m512i = avx::cvt_64(data, byteswap);
-    // Convert u/int64 to floats
-    auto payload_m512 = __m512d{};
+    // Convert u/int64 to doubles
     if constexpr (std::is_signed_v<T>) {
-        payload_m512 = _mm512_cvtepi64_pd(data_m512i);
+        return _mm512_cvtepi64_pd(data_m512i);
     } else {
-        payload_m512 = _mm512_cvtepu64_pd(data_m512i);
+        return _mm512_cvtepu64_pd(data_m512i);
     }
+}
+
+inline auto load_ps(const float* data, bool byteswap=false) -> __m512 {
+    auto loaded = _mm512_loadu_si512(data);
+    if (byteswap) {
+        loaded = _mm512_shuffle_epi8(loaded, avx::swap::shuffle_u32_16);
+    }
+    return _mm512_castsi512_ps(loaded);
+}
+
+inline auto load_pd(const float* data, bool byteswap=false) -> __m512d {
+    auto loaded = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    if (byteswap) {
+        loaded = _mm256_shuffle_epi8(loaded, avx::swap::shuffle_u32_8);
+    }
+    return _mm512_cvtps_pd(_mm256_castsi256_ps(loaded));
+}
+
+inline auto load_packed12_ps(const uint8_t* data, bool byteswap=false) -> __m512 {
+    return _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(avx::packed12::cvt_16x16(data, byteswap)));
+}
+
+inline auto load_packed12_pd(const uint8_t* data, bool byteswap=false) -> __m512d {
+    return _mm512_cvtepi64_pd(_mm512_cvtepi16_epi64(avx::packed12::cvt_16x8(data, byteswap)));
+}
+
+template <typename T>
+auto convert(const T* data, float* dst, bool byteswap=false) -> void {
+    // Stored result into dst
+    _mm512_store_ps(dst, load_ps(data, byteswap));
+}
+
+template <typename T>
+auto convert(const T* data, double* dst, bool byteswap=false) -> void {
     // Stored result into dst
-    _mm512_store_pd(dst, payload_m512);
-}
\ No newline at end of file
+    _mm512_store_pd(dst, load_pd(data, byteswap));
+}
+
+/*
+ * Payload sample formats. Each converts one full register of output
+ * (16 floats or 8 doubles) per call, reading sample_bits() per scalar.
+ */
+enum class sample_format {
+    INT8,
+    UINT8,
+    PACKED12,
+    INT16,
+    INT32,
+    FLOAT32
+};
+
+inline auto parse_sample_format(std::string_view name) -> std::optional<sample_format> {
+    using enum sample_format;
+    if (name == "int8") {
+        return INT8;
+    } else if (name == "uint8") {
+        return UINT8;
+    } else if (name == "packed12") {
+        return PACKED12;
+    } else if (name == "int16") {
+        return INT16;
+    } else if (name == "int32") {
+        return INT32;
+    } else if (name == "float32") {
+        return FLOAT32;
+    }
+    return {};
+}
+
+inline auto sample_bits(sample_format format) -> unsigned {
+    using enum sample_format;
+    switch (format) {
+        case INT8:
+        case UINT8:
+            return 8;
+        case PACKED12:
+            return 12;
+        case INT16:
+            return 16;
+        case INT32:
+        case FLOAT32:
+            return 32;
+    }
+    return 0;
+}
+
+namespace avx {
+
+template <typename T>
+struct reg {};
+
+template <>
+struct reg<float> {
+    using type = __m512;
+};
+
+template <>
+struct reg<double> {
+    using type = __m512d;
+};
+
+// One 512 bit register of T
+template <typename T>
+using reg_t = typename reg<T>::type;
+
+} // namespace avx
+
+// One register of output (16 floats or 8 doubles) from a payload of the given format
+template <sample_format Format, typename Out>
+auto load_payload(const uint8_t* data, bool byteswap) -> avx::reg_t<Out> {
+    using enum sample_format;
+    if constexpr (std::is_same_v<Out, float>) {
+        if constexpr (Format == INT8) {
+            return load_ps(reinterpret_cast<const int8_t*>(data));
+        } else if constexpr (Format == UINT8) {
+            return load_ps(data);
+        } else if constexpr (Format == PACKED12) {
+            return load_packed12_ps(data, byteswap);
+        } else if constexpr (Format == INT16) {
+            return load_ps(reinterpret_cast<const int16_t*>(data), byteswap);
+        } else if constexpr (Format == INT32) {
+            return load_ps(reinterpret_cast<const int32_t*>(data), byteswap);
+        } else {
+            return load_ps(reinterpret_cast<const float*>(data), byteswap);
+        }
+    } else {
+        if constexpr (Format == INT8) {
+            return load_pd(reinterpret_cast<const int8_t*>(data));
+        } else if constexpr (Format == UINT8) {
+            return load_pd(data);
+        } else if constexpr (Format == PACKED12) {
+            return load_packed12_pd(data, byteswap);
+        } else if constexpr (Format == INT16) {
+            return load_pd(reinterpret_cast<const int16_t*>(data), byteswap);
+        } else if constexpr (Format == INT32) {
+            return load_pd(reinterpret_cast<const int32_t*>(data), byteswap);
+        } else {
+            return load_pd(reinterpret_cast<const float*>(data), byteswap);
+        }
+    }
+}
+
+// Loader for a format, resolved once so the sample loop does not branch on it
+template <typename Out>
+auto payload_loader(sample_format format) -> avx::reg_t<Out> (*)(const uint8_t*, bool) {
+    using enum sample_format;
+    switch (format) {
+        case INT8:
+            return &load_payload<INT8, Out>;
+        case UINT8:
+            return &load_payload<UINT8, Out>;
+        case PACKED12:
+            return &load_payload<PACKED12, Out>;
+        case INT16:
+            return &load_payload<INT16, Out>;
+        case INT32:
+            return &load_payload<INT32, Out>;
+        case FLOAT32:
+            return &load_payload<FLOAT32, Out>;
+    }
+    return nullptr;
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <sequence.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/*
+ * Restores packet order on a wrapping sequence counter. Packets up to
+ * depth - 1 ahead of the expected one are held; once depth packets are
+ * waiting, or one arrives beyond the window, the missing ones are given up
+ * as lost. Packets behind the expected count (late or duplicate) are
+ * dropped, and so are parity counts, which carry no samples. With nothing
+ * held, an in-order packet is passed straight through.
+ */
+template <typename Entry>
+class reorder_buffer {
+public:
+    reorder_buffer() = default;
+
+    // The slots must divide the modulus for consecutive indices to stay
+    // distinct across the wrap, which bounds the depth
+    reorder_buffer(sequence::numbering counter, std::size_t depth) :
+      m_numbering(counter),
+      m_modulus(counter.modulus()),
+      m_depth(std::clamp<std::size_t>(depth, 1, std::max<std::size_t>(
+          std::min<uint64_t>(m_modulus / 2, m_modulus & (~m_modulus + 1)), 1))),
+      m_slots(std::bit_ceil(m_depth)) {}
+
+    // emit(Entry) is called for packets in order, lost(count) for gaps
+    template <typename Emit, typename Lost>
+    auto push(uint32_t count, const Entry& entry, Emit&& emit, Lost&& lost) -> void {
+        if (m_numbering.parity(count)) {
+            return;
+        }
+        auto seq = uint64_t{m_numbering.index(count)};
+        if (!m_started) {
+            m_started = true;
+            m_expected = seq;
+        }
+        // In order, nothing held
+        if (m_pending == 0 && seq == m_expected) {
+            emit(entry);
+            m_expected = next(seq);
+            return;
+        }
+        auto ahead = distance(seq);
+        if (ahead >= m_modulus / 2) {
+            ++m_late;
+            return;
+        }
+        // Beyond the window: give up on what it cannot hold
+        while (ahead >= m_depth) {
+            if (m_pending == 0) {
+                lost(static_cast<uint32_t>(ahead));
+                m_expected = seq;
+                ahead = 0;
+                break;
+            }
+            release(emit, lost);
+            ahead = distance(seq);
+        }
+        if (ahead == 0) {
+            emit(entry);
+            m_expected = next(seq);
+            drain(emit);
+            return;
+        }
+        auto& held = slot(seq);
+        if (held) {
+            ++m_late;
+            return;
+        }
+        held = entry;
+        ++m_pending;
+        if (m_pending >= m_depth) {
+            release(emit, lost);
+        }
+    }
+
+    // Gives up on every gap still open, passing on all held packets
+    template <typename Emit, typename Lost>
+    auto flush(Emit&& emit, Lost&& lost) -> void {
+        while (m_pending > 0) {
+            release(emit, lost);
+        }
+    }
+
+    auto pending() const -> std::size_t {
+        return m_pending;
+    }
+
+    // Late and duplicate packets dropped
+    auto late() const -> uint64_t {
+        return m_late;
+    }
+
+private:
+    sequence::numbering m_numbering;
+    uint64_t m_modulus{1};
+    std::size_t m_depth{1};
+    std::vector<std::optional<Entry>> m_slots{1};
+    std::size_t m_pending{};
+    uint64_t m_expected{};
+    bool m_started{false};
+    uint64_t m_late{};
+
+    auto next(uint64_t seq) const -> uint64_t {
+        return (seq + 1) % m_modulus;
+    }
+
+    auto distance(uint64_t seq) const -> uint64_t {
+        return (seq + m_modulus - m_expected) % m_modulus;
+    }
+
+    auto slot(uint64_t seq) -> std::optional<Entry>& {
+        return m_slots[seq & (m_slots.size() - 1)];
+    }
+
+    template <typename Emit>
+    auto drain(Emit& emit) -> void {
+        while (m_pending > 0 && slot(m_expected)) {
+            emit(*slot(m_expected));
+            slot(m_expected).reset();
+            --m_pending;
+            m_expected = next(m_expected);
+        }
+    }
+
+    // Skips the missing packets before the oldest held one, then drains
+    template <typename Emit, typename Lost>
+    auto release(Emit& emit, Lost& lost) -> void {
+        auto missing = uint32_t{};
+        while (!slot(m_expected)) {
+            ++missing;
+            m_expected = next(m_expected);
+        }
+        lost(missing);
+        drain(emit);
+    }
+
+}; // class reorder_buffer
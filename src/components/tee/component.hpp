@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <aligned_mem.hpp>
+
+#include <algorithm>
+#include <array>
+#include <composite/component.hpp>
+#include <memory>
+#include <string>
+
+/*
+ * Fans each frame out to up to MAX_OUTPUTS consumers. Every output gets the
+ * same immutable frame, so nothing is copied unless a consumer modifies it
+ * in place (aligned::writable).
+ */
+template <typename T>
+class tee : public composite::component {
+    using frame_t = aligned::shared_mem<T>;
+    using input_port_t = composite::input_port<frame_t>;
+    using output_port_t = composite::output_port<frame_t>;
+    static constexpr std::size_t MAX_OUTPUTS{8};
+public:
+    tee() : composite::component("tee") {
+        add_port(m_in_port.get());
+        for (auto idx = std::size_t{}; idx < MAX_OUTPUTS; ++idx) {
+            m_out_ports[idx] = std::make_unique<output_port_t>("data_out_" + std::to_string(idx));
+            add_port(m_out_ports[idx].get());
+        }
+        add_property("num_outputs", &m_num_outputs);
+    }
+
+    ~tee() override = default;
+
+    auto initialize() -> void override {
+        m_num_outputs = std::clamp<uint32_t>(m_num_outputs, 1, MAX_OUTPUTS);
+    }
+
+    auto process() -> composite::retval override {
+        using enum composite::retval;
+        auto [data, ts] = m_in_port->get_data();
+        if (data == nullptr) {
+            return NOOP;
+        }
+        for (auto idx = uint32_t{1}; idx < m_num_outputs; ++idx) {
+            m_out_ports[idx]->send_data(data, ts);
+        }
+        // The first output takes over our reference
+        m_out_ports[0]->send_data(std::move(data), ts);
+        return NORMAL;
+    }
+
+private:
+    // Ports
+    std::unique_ptr<input_port_t> m_in_port{std::make_unique<input_port_t>("data_in")};
+    std::array<std::unique_ptr<output_port_t>, MAX_OUTPUTS> m_out_ports;
+
+    // Properties
+    uint32_t m_num_outputs{2};
+
+}; // class tee
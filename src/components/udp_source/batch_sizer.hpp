@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+namespace udpsrc {
+
+/*
+ * Picks how many datagrams to wait for before a batch is passed on. The
+ * arrival rate is tracked as a moving average over flushed batches, and the
+ * target is what is expected to arrive within the flush deadline, so quiet
+ * feeds flush small batches promptly and busy ones fill to max_msgs.
+ */
+class batch_sizer {
+public:
+    using clock = std::chrono::steady_clock;
+
+    batch_sizer() = default;
+
+    batch_sizer(std::size_t min_msgs, std::size_t max_msgs, std::chrono::microseconds deadline) :
+      m_min(std::clamp<std::size_t>(min_msgs, 1, std::max<std::size_t>(max_msgs, 1))),
+      m_max(std::max<std::size_t>(max_msgs, 1)),
+      m_deadline(deadline),
+      m_target(m_max) {}
+
+    auto target() const -> std::size_t {
+        return m_target;
+    }
+
+    auto deadline() const -> std::chrono::microseconds {
+        return m_deadline;
+    }
+
+    // Fold in a flushed batch of count datagrams
+    auto update(std::size_t count) -> void {
+        auto now = clock::now();
+        auto interval = std::chrono::duration<double>(now - m_last_flush).count();
+        m_last_flush = now;
+        if (interval <= 0.0 || interval > MAX_INTERVAL) {
+            // First batch or after an idle spell; keep the previous estimate
+            return;
+        }
+        auto rate = static_cast<double>(count) / interval;
+        m_rate = m_rate == 0.0 ? rate : m_rate + (WEIGHT * (rate - m_rate));
+        auto expected = std::ceil(m_rate * std::chrono::duration<double>(m_deadline).count());
+        m_target = std::clamp(static_cast<std::size_t>(expected), m_min, m_max);
+    }
+
+private:
+    static constexpr double WEIGHT = 0.25;
+    static constexpr double MAX_INTERVAL = 1.0;
+
+    std::size_t m_min{1};
+    std::size_t m_max{1};
+    std::chrono::microseconds m_deadline{};
+    std::size_t m_target{1};
+    double m_rate{};  // datagrams per second
+    clock::time_point m_last_flush{};
+
+}; // class batch_sizer
+
+} // namespace udpsrc
@@ -27,8 +27,11 @@
 #include <net/if.h>
 #include <mutex>
 #include <poll.h>
-#include <queue>
+#include <pthread.h>
+#include <algorithm>
 #include <ranges>
+#include <sched.h>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <sys/ioctl.h>
@@ -38,18 +41,6 @@
 
 namespace udpsrc::net {
 
-mmsgs::mmsgs(size_t num_msgs, size_t msg_size) :
-  msgs(num_msgs),
-  iovecs(num_msgs),
-  buffer(std::make_unique<std::vector<uint8_t>>(num_msgs * msg_size, 0xFF)) {
-    for (auto i=0u; i<num_msgs; ++i) {
-        iovecs.at(i).iov_base = buffer->data() + (i * msg_size);
-        iovecs.at(i).iov_len = msg_size;
-        msgs.at(i).msg_hdr.msg_iov = &iovecs.at(i);
-        msgs.at(i).msg_hdr.msg_iovlen = 1;
-    }
-}
-
 auto get_interface_ip(int fd, std::string_view interface) -> std::string {
     struct ifreq ifr{};
     ifr.ifr_addr.sa_family = AF_INET;
@@ -60,6 +51,80 @@ auto get_interface_ip(int fd, std::string_view interface) -> std::string {
     return {};
 }
 
+auto is_multicast(const std::string& ip_addr) -> bool {
+    auto addr = ntohl(inet_addr(ip_addr.c_str()));
+    return addr >= ntohl(inet_addr("224.0.0.0")) && addr <= ntohl(inet_addr("239.255.255.255"));
+}
+
+auto split(std::string_view list) -> std::vector<std::string> {
+    auto items = std::vector<std::string>{};
+    for (auto item : std::views::split(list, ',')) {
+        if (auto value = std::string_view{item.begin(), item.end()}; !value.empty()) {
+            items.emplace_back(value);
+        }
+    }
+    return items;
+}
+
+auto pin(pthread_t thread, int cpu) -> void {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    pthread_setaffinity_np(thread, sizeof(cpus), &cpus);
+}
+
+auto cpu_index(const std::string& cpu) -> int {
+    return cpu.empty() ? -1 : std::stoi(cpu);
+}
+
+receiver::~receiver() {
+    thread.request_stop();
+    if (thread.joinable()) {
+        thread.join();
+    }
+    close(socket);
+}
+
+auto now() -> composite::timestamp {
+    auto nsecs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch());
+    return batch::to_timestamp<composite::timestamp>(nsecs.count());
+}
+
+auto batch_time(const batch::packet_batch& batch) -> composite::timestamp {
+    // Arrival of the first datagram when the kernel stamped it
+    if (!batch.empty() && batch.timestamp(0) != 0) {
+        return batch::to_timestamp<composite::timestamp>(batch.timestamp(0));
+    }
+    return now();
+}
+
+auto fill(int fd, mmsgs& data, int received, batch_sizer& sizer, bool busy_poll) -> int {
+    // Top up a batch that has its first datagrams until it reaches the target
+    // or the flush deadline, counted from the first receive, has passed.
+    // Busy polling retries the receive instead of sleeping in ppoll().
+    using timespec_t = struct timespec;
+    auto filled = static_cast<std::size_t>(received);
+    auto target = std::min(sizer.target(), data.msgs.size());
+    auto deadline = batch_sizer::clock::now() + sizer.deadline();
+    auto pfd = pollfd{.fd = fd, .events = POLLIN, .revents = 0};
+    while (filled < target) {
+        auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - batch_sizer::clock::now());
+        if (remaining.count() <= 0) {
+            break;
+        }
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+        auto timeout = timespec_t{.tv_sec = secs.count(), .tv_nsec = (remaining - secs).count()};
+        if (!busy_poll && ppoll(&pfd, 1, &timeout, nullptr) <= 0) {
+            continue;
+        }
+        if (auto recvd = recvmmsg(fd, data.msgs.data() + filled, target - filled, MSG_DONTWAIT, nullptr); recvd > 0) {
+            filled += recvd;
+        }
+    }
+    sizer.update(filled);
+    return static_cast<int>(filled);
+}
+
 } // namespace udpsrc::net
 
 
@@ -73,6 +138,25 @@ udp_source::udp_source() :
     add_property("recv_buf_size", &m_recv_buf_size);
     add_property("msg_size", &m_msg_size);
     add_property("num_msgs", &m_num_msgs);
+    add_property("pool_size", &m_pool_size);
+    add_property("rx_mode", &m_rx_mode);
+    add_property("ring_block_size", &m_ring_block_size);
+    add_property("ring_num_blocks", &m_ring_num_blocks);
+    add_property("ring_block_timeout", &m_ring_block_timeout);
+    add_property("num_receivers", &m_num_receivers);
+    add_property("receiver_cpus", &m_receiver_cpus);
+    add_property("wakeup", &m_wakeup);
+    add_property("rx_timestamp", &m_rx_timestamp);
+    add_property("adaptive_batch", &m_adaptive_batch);
+    add_property("min_msgs", &m_min_msgs);
+    add_property("flush_deadline", &m_flush_deadline);
+    add_property("batch_target", &m_batch_target);
+    add_property("kernel_drops", &m_kernel_drops);
+    add_property("busy_poll", &m_busy_poll);
+    add_property("filler_cpu", &m_filler_cpu);
+    add_property("process_cpu", &m_process_cpu);
+    add_property("ready_empty", &m_ready_empty);
+    add_property("ready_sleeps", &m_ready_sleeps);
 }
 
 udp_source::~udp_source() {
@@ -80,27 +164,130 @@ udp_source::~udp_source() {
 }
 
 auto udp_source::initialize() -> void {
+    // Select receive path
+    if (m_rx_mode == "packet_mmap") {
+        m_mode = rx_mode::PACKET_MMAP;
+    } else if (m_rx_mode == "io_uring") {
+        m_mode = rx_mode::IO_URING;
+    } else {
+        m_mode = rx_mode::RECVMMSG;
+    }
+    // An empty pool would leave the filler waiting for a free batch forever
+    if (m_pool_size == 0) {
+        throw std::runtime_error("udp_source: pool_size must be at least 1");
+    }
+    m_timestamping = udpsrc::net::parse_rx_timestamp(m_rx_timestamp);
+    m_ready_wakeup = std::make_unique<udpsrc::wakeup>(udpsrc::wakeup::parse(m_wakeup));
+    // Without adaptive batching every receive asks for all num_msgs
+    auto sizer = m_adaptive_batch ?
+        udpsrc::batch_sizer(m_min_msgs, m_num_msgs, std::chrono::microseconds(m_flush_deadline)) :
+        udpsrc::batch_sizer(m_num_msgs, m_num_msgs, {});
+    m_sizer = sizer;
+    auto addrs = udpsrc::net::split(m_ip_addr);
+    if (m_mode == rx_mode::RECVMMSG && m_num_receivers > 1) {
+        // One SO_REUSEPORT socket, pool and thread per receiver. Receiver i
+        // takes the i-th address of ip_addr, wrapping around.
+        auto cpus = udpsrc::net::split(m_receiver_cpus);
+        // SO_REUSEPORT does not balance multicast: every socket that joined a
+        // group gets its own copy of each datagram, so the merged output
+        // would carry it once per receiver sharing the group
+        auto groups = std::vector<std::string>{};
+        for (auto i=0u; i<m_num_receivers && !addrs.empty(); ++i) {
+            const auto& addr = addrs.at(i % addrs.size());
+            if (!udpsrc::net::is_multicast(addr)) {
+                continue;
+            }
+            if (std::ranges::find(groups, addr) != groups.end()) {
+                throw std::runtime_error("udp_source: num_receivers would have several receivers join multicast group " + addr);
+            }
+            groups.push_back(addr);
+        }
+        for (auto i=0u; i<m_num_receivers; ++i) {
+            auto rx = std::make_unique<udpsrc::net::receiver>();
+            rx->socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+            rx->pool = std::make_shared<udpsrc::net::mmsgs_pool>(m_pool_size, m_num_msgs, m_msg_size);
+            rx->ready = std::make_unique<udpsrc::spsc_ring<udpsrc::net::ready_t>>(m_pool_size);
+            rx->sizer = sizer;
+            rx->cpu = cpus.empty() ? -1 : udpsrc::net::cpu_index(cpus.at(i % cpus.size()));
+            configure_socket(rx->socket, addrs.empty() ? std::string{} : addrs.at(i % addrs.size()), true);
+            m_receivers.emplace_back(std::move(rx));
+        }
+        return;
+    }
+    // The ring's filter matches one destination address
+    if (m_mode == rx_mode::PACKET_MMAP && addrs.size() > 1) {
+        throw std::runtime_error("udp_source: packet_mmap takes a single ip_addr, not " + m_ip_addr);
+    }
     // Setup poll
     m_pfds.at(0).fd = m_socket;
     m_pfds.at(0).events = POLLIN;
+    configure_socket(m_socket, addrs.empty() ? std::string{} : addrs.front(), false);
+    if (m_mode == rx_mode::RECVMMSG) {
+        // Setup pool of mmsg headers with iovec buffers; the ready ring can
+        // hold the whole pool so the filler never finds it full
+        m_pool = std::make_shared<udpsrc::net::mmsgs_pool>(m_pool_size, m_num_msgs, m_msg_size);
+        m_queue = std::make_unique<udpsrc::spsc_ring<std::unique_ptr<udpsrc::net::mmsgs>>>(m_pool_size);
+    }
+    if (m_mode == rx_mode::PACKET_MMAP) {
+        // The UDP socket stays bound and joined so the group membership
+        // holds; datagrams are taken from the ring instead
+        m_ring = std::make_shared<udpsrc::net::packet_ring>(
+            m_interface,
+            addrs.empty() ? std::string{} : addrs.front(),
+            static_cast<uint16_t>(m_port),
+            m_ring_block_size,
+            m_ring_num_blocks,
+            m_ring_block_timeout,
+            m_timestamping == udpsrc::net::rx_timestamp::HARDWARE
+        );
+        m_pfds.at(0).fd = m_ring->fd();
+        m_pfds.at(0).events = POLLIN | POLLERR;
+    }
+    if (m_mode == rx_mode::IO_URING) {
+#ifdef UDP_SOURCE_IO_URING
+        m_uring = std::make_shared<udpsrc::net::uring_receiver>(
+            m_socket,
+            m_msg_size,
+            m_num_msgs,
+            m_pool_size
+        );
+#else
+        throw std::runtime_error("udp_source: built without io_uring support");
+#endif
+    }
+}
+
+auto udp_source::configure_socket(int fd, const std::string& ip_addr, bool reuse_port) -> void {
     // Set receive buffer size
-    setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, (char*)&m_recv_buf_size, sizeof(m_recv_buf_size));
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (char*)&m_recv_buf_size, sizeof(m_recv_buf_size));
     // Set receive timeout
     using timeval_t = struct timeval;
     auto tv = timeval_t{.tv_sec = 1, .tv_usec = 0};
-    setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, (char*)&tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (char*)&tv, sizeof(tv));
     // Set non-blocking
-    fcntl(m_socket, F_SETFL, O_NONBLOCK);
-    // Setup queue of mmsg headers with iovec buffers
-    m_queue_size = m_num_msgs / 2;
-    for (auto _ : std::views::iota(size_t{0}, m_queue_size)) {
-        m_queue.emplace(std::make_unique<udpsrc::net::mmsgs>(m_num_msgs, m_msg_size));
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    // Per-datagram kernel receive time
+    if (!udpsrc::net::enable_timestamps(fd, m_interface, m_timestamping)) {
+        throw std::runtime_error("udp_source: failed to enable rx_timestamp " + m_rx_timestamp);
+    }
+    // Receive queue overflow count
+    udpsrc::net::enable_drop_counter(fd);
+    if (m_busy_poll > 0) {
+        // Let receives poll the device queue for up to busy_poll us. Raising
+        // SO_BUSY_POLL needs CAP_NET_ADMIN; without it receives still spin in
+        // user space.
+        auto usecs = static_cast<int>(m_busy_poll);
+        auto prefer = int{1};
+        setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs));
+        setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer));
+    }
+    if (reuse_port) {
+        auto enable = int{1};
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
     }
     // Determine multicast from address
-    auto multi_addr_start = htonl(inet_addr("224.0.0.0"));
-    auto multi_addr_end = htonl(inet_addr("239.255.255.255"));
-    auto bind_addr = htonl(inet_addr(m_ip_addr.c_str()));
-    auto is_multicast = (bind_addr >= multi_addr_start) && (bind_addr <= multi_addr_end);
+    auto bind_addr = htonl(inet_addr(ip_addr.c_str()));
+    auto is_multicast = udpsrc::net::is_multicast(ip_addr);
     if (is_multicast) {
         bind_addr = INADDR_ANY;
     }
@@ -110,23 +297,50 @@ auto udp_source::initialize() -> void {
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = ntohl(bind_addr);
     addr.sin_port = htons(m_port);
-    bind(m_socket, (struct  sockaddr*)&addr, sizeof(addr));
+    bind(fd, (struct  sockaddr*)&addr, sizeof(addr));
     if (is_multicast) {
         // Multicast group
         struct ip_mreq group{};
-        auto bind_address = udpsrc::net::get_interface_ip(m_socket, m_interface);
+        auto bind_address = udpsrc::net::get_interface_ip(fd, m_interface);
         group.imr_interface.s_addr = inet_addr(bind_address.c_str());
-        group.imr_multiaddr.s_addr = inet_addr(m_ip_addr.c_str());
-        setsockopt(m_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, (char*)&group, sizeof(group));
+        group.imr_multiaddr.s_addr = inet_addr(ip_addr.c_str());
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, (char*)&group, sizeof(group));
+        if (reuse_port) {
+            // Sockets sharing the port only see the groups they joined
+            auto all = int{0};
+            setsockopt(fd, IPPROTO_IP, IP_MULTICAST_ALL, &all, sizeof(all));
+        }
     }
 }
 
 auto udp_source::start() -> void {
-    m_filler = std::jthread(&udp_source::keep_full, this);
+    for (auto i=0u; i<m_receivers.size(); ++i) {
+        auto rx = m_receivers.at(i).get();
+        rx->thread = std::jthread([this, rx, i](std::stop_token token) { receive_loop(token, rx, i); });
+        if (rx->cpu >= 0) {
+            udpsrc::net::pin(rx->thread.native_handle(), rx->cpu);
+        }
+    }
+    if (m_mode == rx_mode::RECVMMSG && m_receivers.empty()) {
+        m_filler = std::jthread([this](std::stop_token token) { keep_full(token); });
+        if (auto cpu = udpsrc::net::cpu_index(m_filler_cpu); cpu >= 0) {
+            udpsrc::net::pin(m_filler.native_handle(), cpu);
+        }
+    }
+    // process() runs on a thread owned by the runtime, so it pins itself
+    m_pin_process = udpsrc::net::cpu_index(m_process_cpu);
     composite::component::start();
 }
 
 auto udp_source::stop() -> void {
+    for (auto& rx : m_receivers) {
+        rx->thread.request_stop();
+    }
+    for (auto& rx : m_receivers) {
+        if (rx->thread.joinable()) {
+            rx->thread.join();
+        }
+    }
     m_filler.request_stop();
     if (m_filler.joinable()) {
         m_filler.join();
@@ -135,44 +349,186 @@ auto udp_source::stop() -> void {
 }
 
 auto udp_source::process() -> composite::retval {
+    if (m_pin_process >= 0) [[unlikely]] {
+        udpsrc::net::pin(pthread_self(), m_pin_process);
+        m_pin_process = -1;
+    }
+    if (!m_receivers.empty()) {
+        return process_fanin();
+    }
+    switch (m_mode) {
+        case rx_mode::PACKET_MMAP:
+            return process_ring();
+        case rx_mode::IO_URING:
+            return process_uring();
+        default:
+            return process_mmsgs();
+    }
+}
+
+auto udp_source::process_mmsgs() -> composite::retval {
     using enum composite::retval;
-    auto data = std::unique_ptr<udpsrc::net::mmsgs>{nullptr};
-    {
-        auto lk = std::scoped_lock{m_mtx};
-        if (m_queue.empty()) {
+    // Reuse a batch left over from a timed out receive before taking a new one
+    auto data = std::move(m_pending);
+    if (data == nullptr && !m_queue->try_pop(data)) {
+        ++m_ready_empty;
+        auto ready = m_ready_wakeup->wait([this]{ return !m_queue->empty(); }, std::chrono::seconds(1));
+        m_ready_sleeps = m_ready_wakeup->sleeps();
+        if (!ready || !m_queue->try_pop(data)) {
             return NO_YIELD;
         }
-        data = std::move(m_queue.front());
-        m_queue.pop();
-        m_cv.notify_one();
-    }
-    if (data == nullptr) {
-        return NO_YIELD;
     }
     using timespec_t = struct timespec;
     auto timeout = timespec_t{.tv_sec = 1, .tv_nsec = 0};
-    if (auto num_events = poll(m_pfds.data(), 1, 1000/*1s*/)) [[likely]] {
+    // Busy polling skips poll() and spins on the non-blocking receive
+    auto num_events = m_busy_poll > 0 ? 1 : poll(m_pfds.data(), 1, 1000/*1s*/);
+    if (num_events > 0) [[likely]] {
         // check socket is ready to read
-        if (m_pfds.at(0).revents & POLLIN) [[likely]] {
-            if (auto recvd = recvmmsg(m_socket, data->msgs.data(), data->msgs.size(), 0, &timeout); recvd != -1) {
-                data->buffer->resize(recvd * m_msg_size);
-                auto now = std::chrono::system_clock::now();
-                auto secs = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch());
-                auto nsecs = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch());
-                m_out_port->send_data(std::move(data->buffer), {static_cast<uint32_t>(secs.count()), static_cast<uint64_t>((nsecs - secs).count())});
+        if (m_busy_poll > 0 || (m_pfds.at(0).revents & POLLIN)) [[likely]] {
+            if (auto recvd = recvmmsg(m_socket, data->msgs.data(), m_sizer.target(), 0, &timeout); recvd != -1) {
+                if (m_adaptive_batch) {
+                    recvd = udpsrc::net::fill(m_socket, *data, recvd, m_sizer, m_busy_poll > 0);
+                    m_batch_target = m_sizer.target();
+                }
+                for (auto i=0; i<recvd; ++i) {
+                    const auto& msg = data->msgs.at(i);
+                    data->batch.push_back(i * m_msg_size, msg.msg_len, udpsrc::net::kernel_timestamp(msg.msg_hdr));
+                }
+                if (auto drops = udpsrc::net::kernel_drops(data->msgs.at(recvd - 1).msg_hdr)) {
+                    m_kernel_drops = *drops;
+                }
+                auto ts = udpsrc::net::batch_time(data->batch);
+                m_out_port->send_data(m_pool->share(std::move(data)), ts);
+                return NO_YIELD;
+            }
+        }
+    }
+    m_pending = std::move(data);
+    return NO_YIELD;
+}
+
+auto udp_source::process_ring() -> composite::retval {
+    using enum composite::retval;
+    auto data = m_ring->next();
+    if (data == nullptr) {
+        // The next block is still held downstream. poll() would keep
+        // reporting it as ready, so wait for its release instead.
+        if (m_ring->held()) {
+            m_ring->wait_released(std::chrono::seconds(1));
+            return NO_YIELD;
+        }
+        // Wait for the kernel to retire a block
+        if (poll(m_pfds.data(), 1, 1000/*1s*/) <= 0) {
+            return NO_YIELD;
+        }
+        if (data = m_ring->next(); data == nullptr) {
+            return NO_YIELD;
+        }
+    }
+    auto ts = udpsrc::net::batch_time(*data);
+    m_out_port->send_data(std::move(data), ts);
+    m_kernel_drops = m_ring->drops();
+    return NO_YIELD;
+}
+
+auto udp_source::process_uring() -> composite::retval {
+    using enum composite::retval;
+#ifdef UDP_SOURCE_IO_URING
+    if (auto data = m_uring->receive(std::chrono::seconds(1))) {
+        auto ts = udpsrc::net::batch_time(*data);
+        m_out_port->send_data(std::move(data), ts);
+        m_kernel_drops = m_uring->drops();
+    }
+#endif
+    return NO_YIELD;
+}
+
+auto udp_source::process_fanin() -> composite::retval {
+    using enum composite::retval;
+    // Round-robin over the receivers' rings so none is starved
+    auto try_pop = [this](udpsrc::net::ready_t& ready) {
+        for (auto i=0u; i<m_receivers.size(); ++i) {
+            auto& rx = m_receivers.at((m_next_receiver + i) % m_receivers.size());
+            if (rx->ready->try_pop(ready)) {
+                m_next_receiver = (m_next_receiver + i + 1) % m_receivers.size();
+                return true;
             }
         }
+        return false;
+    };
+    auto ready = udpsrc::net::ready_t{};
+    if (!try_pop(ready)) {
+        ++m_ready_empty;
+        m_ready_wakeup->wait([this]{
+            return std::ranges::any_of(m_receivers, [](const auto& rx) { return !rx->ready->empty(); });
+        }, std::chrono::seconds(1));
+        m_ready_sleeps = m_ready_wakeup->sleeps();
+        if (!try_pop(ready)) {
+            return NO_YIELD;
+        }
+    }
+    m_out_port->send_data(std::move(ready.first), ready.second);
+    auto drops = uint64_t{};
+    auto target = uint64_t{};
+    for (const auto& rx : m_receivers) {
+        drops += rx->drops.load(std::memory_order_relaxed);
+        target += rx->batch_target.load(std::memory_order_relaxed);
+    }
+    m_kernel_drops = drops;
+    if (m_adaptive_batch) {
+        // Mean over the receivers, each sizing its own batches
+        m_batch_target = target / m_receivers.size();
     }
     return NO_YIELD;
 }
 
+auto udp_source::receive_loop(std::stop_token token, udpsrc::net::receiver* rx, uint32_t id) -> void {
+    auto pfd = pollfd{.fd = rx->socket, .events = POLLIN, .revents = 0};
+    auto msgs = std::unique_ptr<udpsrc::net::mmsgs>{};
+    while (!token.stop_requested()) {
+        if (msgs == nullptr) {
+            // Each receiver rearms its own buffers
+            if (msgs = rx->pool->acquire(std::chrono::seconds(1)); msgs == nullptr) {
+                continue;
+            }
+            msgs->rearm();
+        }
+        if (m_busy_poll == 0 && (poll(&pfd, 1, 1000/*1s*/) <= 0 || (pfd.revents & POLLIN) == 0)) {
+            continue;
+        }
+        auto recvd = recvmmsg(rx->socket, msgs->msgs.data(), rx->sizer.target(), 0, nullptr);
+        if (recvd <= 0) {
+            continue;
+        }
+        if (m_adaptive_batch) {
+            recvd = udpsrc::net::fill(rx->socket, *msgs, recvd, rx->sizer, m_busy_poll > 0);
+            rx->batch_target.store(rx->sizer.target(), std::memory_order_relaxed);
+        }
+        for (auto i=0; i<recvd; ++i) {
+            const auto& msg = msgs->msgs.at(i);
+            msgs->batch.push_back(i * m_msg_size, msg.msg_len, udpsrc::net::kernel_timestamp(msg.msg_hdr));
+        }
+        if (auto drops = udpsrc::net::kernel_drops(msgs->msgs.at(recvd - 1).msg_hdr)) {
+            rx->drops.store(*drops, std::memory_order_relaxed);
+        }
+        msgs->batch.set_receiver(id);
+        auto ts = udpsrc::net::batch_time(msgs->batch);
+        // Sized to the pool, so the push cannot fail
+        rx->ready->try_push({rx->pool->share(std::move(msgs)), ts});
+        m_ready_wakeup->notify();
+    }
+}
+
 auto udp_source::keep_full(std::stop_token token) -> void {
     while (!token.stop_requested()) {
-        auto lk = std::unique_lock{m_mtx};
-        m_cv.wait_for(lk, std::chrono::seconds(1), [this]{ return m_queue.size() < m_queue_size; });
-        if (m_queue.size() < m_queue_size) {
-            m_queue.emplace(std::make_unique<udpsrc::net::mmsgs>(m_num_msgs, m_msg_size));
+        // Recycled buffers are rearmed here, off the receive path
+        auto msgs = m_pool->acquire(std::chrono::seconds(1));
+        if (msgs == nullptr) {
+            continue;
         }
+        msgs->rearm();
+        m_queue->try_push(std::move(msgs));
+        m_ready_wakeup->notify();
     }
 }
 
@@ -17,40 +17,80 @@
  * along with this program.  If not, see http://www.gnu.org/licenses/.
  */
 
+#include "batch_sizer.hpp"
+#include "mmsgs.hpp"
+#include "packet_ring.hpp"
+#include "spsc_ring.hpp"
+#include "control_msgs.hpp"
+#include "wakeup.hpp"
+#ifdef UDP_SOURCE_IO_URING
+#include "uring_receiver.hpp"
+#endif
+
+#include <packet_batch.hpp>
+
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <composite/component.hpp>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <poll.h>
-#include <queue>
+#include <pthread.h>
 #include <string>
 #include <string_view>
 #include <sys/socket.h>
 #include <sys/uio.h>
 #include <thread>
 #include <unistd.h>
+#include <utility>
+#include <vector>
 
 namespace udpsrc::net {
 
-class mmsgs {
-public:
-    using buffer_type = std::vector<uint8_t>;
+using ready_t = std::pair<std::shared_ptr<batch::packet_batch>, composite::timestamp>;
 
-    mmsgs(size_t num_msgs, size_t msg_size);
+// Receive socket with its own buffer pool, serviced by a dedicated thread
+struct receiver {
+    ~receiver();
 
-    std::vector<struct mmsghdr> msgs;
-    std::vector<struct iovec> iovecs;
-    std::unique_ptr<buffer_type> buffer;
-
-}; // class mmsgs
+    int socket{-1};
+    int cpu{-1};
+    std::shared_ptr<mmsgs_pool> pool;
+    std::unique_ptr<spsc_ring<ready_t>> ready;
+    batch_sizer sizer;
+    std::atomic<uint64_t> drops{};
+    std::atomic<uint64_t> batch_target{};
+    std::jthread thread;
+};
 
 auto get_interface_ip(int fd, std::string_view interface) -> std::string;
+auto is_multicast(const std::string& ip_addr) -> bool;
+auto split(std::string_view list) -> std::vector<std::string>;
+auto pin(pthread_t thread, int cpu) -> void;
+auto cpu_index(const std::string& cpu) -> int;
+auto now() -> composite::timestamp;
+auto batch_time(const batch::packet_batch& batch) -> composite::timestamp;
+auto fill(int fd, mmsgs& data, int received, batch_sizer& sizer, bool busy_poll) -> int;
 
 } // namespace udpsrc::net
 
 class udp_source : public composite::component {
-    using output_t = std::vector<uint8_t>;
+    using output_t = batch::packet_batch;
     using output_port_t = composite::output_port<std::shared_ptr<output_t>>;
     static constexpr std::uint32_t RECV_BUF_SIZE{0xFFFF};
+    static constexpr std::uint32_t POOL_SIZE{16};
+    static constexpr std::uint32_t RING_BLOCK_SIZE{1 << 22};
+    static constexpr std::uint32_t RING_NUM_BLOCKS{64};
+    static constexpr std::uint32_t RING_BLOCK_TIMEOUT{10};
+    static constexpr std::uint32_t FLUSH_DEADLINE{1000};
+
+    enum class rx_mode {
+        RECVMMSG,
+        PACKET_MMAP,
+        IO_URING
+    };
 public:
     udp_source();
     ~udp_source() override;
@@ -70,16 +110,51 @@ private:
     uint32_t m_recv_buf_size{RECV_BUF_SIZE};
     uint32_t m_msg_size{};
     uint32_t m_num_msgs{};
+    uint32_t m_pool_size{POOL_SIZE};
+    std::string m_rx_mode{"recvmmsg"};
+    uint32_t m_ring_block_size{RING_BLOCK_SIZE};
+    uint32_t m_ring_num_blocks{RING_NUM_BLOCKS};
+    uint32_t m_ring_block_timeout{RING_BLOCK_TIMEOUT};
+    uint32_t m_num_receivers{1};
+    std::string m_receiver_cpus;
+    std::string m_wakeup{"futex"};
+    std::string m_rx_timestamp{"software"};
+    bool m_adaptive_batch{false};
+    uint32_t m_min_msgs{1};
+    uint32_t m_flush_deadline{FLUSH_DEADLINE};
+    uint64_t m_batch_target{};
+    uint64_t m_kernel_drops{};
+    uint32_t m_busy_poll{};
+    std::string m_filler_cpu;
+    std::string m_process_cpu;
+    uint64_t m_ready_empty{};
+    uint64_t m_ready_sleeps{};
 
     // Members
     int m_socket{-1};
+    rx_mode m_mode{rx_mode::RECVMMSG};
+    udpsrc::net::rx_timestamp m_timestamping{udpsrc::net::rx_timestamp::SOFTWARE};
     std::array<struct pollfd, 1> m_pfds;
-    size_t m_queue_size{m_num_msgs / 2};
-    std::queue<std::unique_ptr<udpsrc::net::mmsgs>> m_queue;
-    std::mutex m_mtx;
-    std::condition_variable m_cv;
+    std::shared_ptr<udpsrc::net::packet_ring> m_ring;
+#ifdef UDP_SOURCE_IO_URING
+    std::shared_ptr<udpsrc::net::uring_receiver> m_uring;
+#endif
+    std::shared_ptr<udpsrc::net::mmsgs_pool> m_pool;
+    std::unique_ptr<udpsrc::net::mmsgs> m_pending;
+    udpsrc::batch_sizer m_sizer;
+    std::unique_ptr<udpsrc::spsc_ring<std::unique_ptr<udpsrc::net::mmsgs>>> m_queue;
+    std::unique_ptr<udpsrc::wakeup> m_ready_wakeup;
     std::jthread m_filler;
+    std::vector<std::unique_ptr<udpsrc::net::receiver>> m_receivers;
+    std::size_t m_next_receiver{};
+    int m_pin_process{-1};
 
+    auto process_mmsgs() -> composite::retval;
+    auto process_ring() -> composite::retval;
+    auto process_uring() -> composite::retval;
+    auto process_fanin() -> composite::retval;
+    auto configure_socket(int fd, const std::string& ip_addr, bool reuse_port) -> void;
+    auto receive_loop(std::stop_token token, udpsrc::net::receiver* rx, uint32_t id) -> void;
     auto keep_full(std::stop_token token) -> void;
 
 }; // class udp_source
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "control_msgs.hpp"
+
+#include <cstring>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <time.h>
+
+namespace udpsrc::net {
+
+namespace {
+
+constexpr int64_t NS_PER_SEC = 1'000'000'000;
+
+auto to_ns(const struct timespec& ts) -> int64_t {
+    return (static_cast<int64_t>(ts.tv_sec) * NS_PER_SEC) + ts.tv_nsec;
+}
+
+} // namespace
+
+auto parse_rx_timestamp(std::string_view name) -> rx_timestamp {
+    if (name == "none") {
+        return rx_timestamp::NONE;
+    }
+    if (name == "hardware") {
+        return rx_timestamp::HARDWARE;
+    }
+    return rx_timestamp::SOFTWARE;
+}
+
+auto enable_timestamps(int fd, std::string_view interface, rx_timestamp mode) -> bool {
+    if (mode == rx_timestamp::NONE) {
+        return true;
+    }
+    if (mode == rx_timestamp::SOFTWARE) {
+        auto enable = int{1};
+        return setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0;
+    }
+    if (!interface.empty()) {
+        // Best effort: the NIC may already be stamping, or not support it
+        auto config = hwtstamp_config{};
+        config.tx_type = HWTSTAMP_TX_OFF;
+        config.rx_filter = HWTSTAMP_FILTER_ALL;
+        struct ifreq ifr{};
+        std::strncpy(ifr.ifr_name, std::string{interface}.c_str(), IFNAMSIZ - 1);
+        ifr.ifr_data = reinterpret_cast<char*>(&config);
+        ioctl(fd, SIOCSHWTSTAMP, &ifr);
+    }
+    auto flags = int{
+        SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+        SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE
+    };
+    return setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0;
+}
+
+auto kernel_timestamp(const struct msghdr& msg) -> int64_t {
+    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(const_cast<struct msghdr*>(&msg), cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+        if (cmsg->cmsg_type == SO_TIMESTAMPNS) {
+            struct timespec ts{};
+            std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            return to_ns(ts);
+        }
+        if (cmsg->cmsg_type == SO_TIMESTAMPING) {
+            // ts[0] is software, ts[2] raw hardware; prefer the NIC's time
+            struct scm_timestamping tss{};
+            std::memcpy(&tss, CMSG_DATA(cmsg), sizeof(tss));
+            auto hw = to_ns(tss.ts[2]);
+            return hw != 0 ? hw : to_ns(tss.ts[0]);
+        }
+    }
+    return 0;
+}
+
+auto enable_drop_counter(int fd) -> bool {
+    auto enable = int{1};
+    return setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) == 0;
+}
+
+auto kernel_drops(const struct msghdr& msg) -> std::optional<uint32_t> {
+    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(const_cast<struct msghdr*>(&msg), cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+            auto drops = uint32_t{};
+            std::memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+            return drops;
+        }
+    }
+    return {};
+}
+
+} // namespace udpsrc::net
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <sys/socket.h>
+#include <time.h>
+// Needs struct timespec from time.h
+#include <linux/errqueue.h>
+
+namespace udpsrc::net {
+
+// Source of per-datagram receive timestamps
+enum class rx_timestamp {
+    NONE,
+    SOFTWARE,  // SO_TIMESTAMPNS, taken by the kernel when the packet arrives
+    HARDWARE   // SO_TIMESTAMPING raw hardware time from the NIC, software fallback
+};
+
+// Control buffer space for the largest timestamp cmsg and the drop counter
+constexpr std::size_t CONTROL_SIZE = CMSG_SPACE(sizeof(struct scm_timestamping)) + CMSG_SPACE(sizeof(uint32_t));
+
+auto parse_rx_timestamp(std::string_view name) -> rx_timestamp;
+
+// Request receive timestamps on a socket. Hardware stamping also asks the
+// driver of interface to stamp all received packets; returns false if the
+// socket option was refused.
+auto enable_timestamps(int fd, std::string_view interface, rx_timestamp mode) -> bool;
+
+// Receive time in ns since the epoch carried by the control data of a
+// received message, or 0 if it has none
+auto kernel_timestamp(const struct msghdr& msg) -> int64_t;
+
+// Have the socket report its overflow drop count (SO_RXQ_OVFL) with every
+// received message
+auto enable_drop_counter(int fd) -> bool;
+
+// Datagrams dropped by the socket since it was opened because its receive
+// queue was full, if the message carries the count
+auto kernel_drops(const struct msghdr& msg) -> std::optional<uint32_t>;
+
+} // namespace udpsrc::net
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "mmsgs.hpp"
+#include "control_msgs.hpp"
+
+#include <ranges>
+
+namespace udpsrc::net {
+
+mmsgs::mmsgs(size_t num_msgs, size_t msg_size) :
+  msgs(num_msgs),
+  iovecs(num_msgs),
+  buffer(num_msgs * msg_size, 0xFF),
+  control(num_msgs * CONTROL_SIZE),
+  batch(num_msgs) {
+    for (auto i=0u; i<num_msgs; ++i) {
+        iovecs.at(i).iov_base = buffer.data() + (i * msg_size);
+        iovecs.at(i).iov_len = msg_size;
+        msgs.at(i).msg_hdr.msg_iov = &iovecs.at(i);
+        msgs.at(i).msg_hdr.msg_iovlen = 1;
+        msgs.at(i).msg_hdr.msg_control = control.data() + (i * CONTROL_SIZE);
+        msgs.at(i).msg_hdr.msg_controllen = CONTROL_SIZE;
+    }
+}
+
+auto mmsgs::rearm() -> void {
+    batch.reset(buffer.data());
+    for (auto& msg : msgs) {
+        msg.msg_hdr.msg_controllen = CONTROL_SIZE;
+    }
+}
+
+mmsgs_pool::mmsgs_pool(size_t pool_size, size_t num_msgs, size_t msg_size) {
+    m_free.reserve(pool_size);
+    for (auto _ : std::views::iota(size_t{0}, pool_size)) {
+        m_free.emplace_back(std::make_unique<mmsgs>(num_msgs, msg_size));
+    }
+}
+
+auto mmsgs_pool::acquire(std::chrono::milliseconds timeout) -> std::unique_ptr<mmsgs> {
+    auto lk = std::unique_lock{m_mtx};
+    if (!m_cv.wait_for(lk, timeout, [this]{ return !m_free.empty(); })) {
+        return nullptr;
+    }
+    auto msgs = std::move(m_free.back());
+    m_free.pop_back();
+    return msgs;
+}
+
+auto mmsgs_pool::share(std::unique_ptr<mmsgs> msgs) -> std::shared_ptr<batch::packet_batch> {
+    // The owner's deleter hands the mmsgs back to this pool; downstream only
+    // sees an aliased pointer to its batch
+    auto raw = msgs.release();
+    auto owner = std::shared_ptr<mmsgs>(raw, [pool = shared_from_this()](mmsgs* released) {
+        pool->release(released);
+    });
+    return std::shared_ptr<batch::packet_batch>(std::move(owner), &raw->batch);
+}
+
+auto mmsgs_pool::release(mmsgs* msgs) -> void {
+    {
+        auto lk = std::scoped_lock{m_mtx};
+        m_free.emplace_back(msgs);
+    }
+    m_cv.notify_one();
+}
+
+} // namespace udpsrc::net
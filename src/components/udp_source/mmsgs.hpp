@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <packet_batch.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+
+namespace udpsrc::net {
+
+class mmsgs {
+public:
+    using buffer_type = std::vector<uint8_t>;
+
+    mmsgs(size_t num_msgs, size_t msg_size);
+
+    // Clear the datagram views left from the previous batch and restore the
+    // control buffer lengths the kernel overwrote
+    auto rearm() -> void;
+
+    std::vector<struct mmsghdr> msgs;
+    std::vector<struct iovec> iovecs;
+    buffer_type buffer;
+    buffer_type control;
+    batch::packet_batch batch;
+
+}; // class mmsgs
+
+/*
+ * Fixed set of pre-wired mmsgs. Buffers handed downstream are returned to the
+ * pool when the last shared_ptr owner releases them, so steady-state receive
+ * never allocates or fills a batch buffer.
+ */
+class mmsgs_pool : public std::enable_shared_from_this<mmsgs_pool> {
+public:
+    mmsgs_pool(size_t pool_size, size_t num_msgs, size_t msg_size);
+
+    auto acquire(std::chrono::milliseconds timeout) -> std::unique_ptr<mmsgs>;
+    auto share(std::unique_ptr<mmsgs> msgs) -> std::shared_ptr<batch::packet_batch>;
+
+private:
+    std::vector<std::unique_ptr<mmsgs>> m_free;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+
+    auto release(mmsgs* msgs) -> void;
+
+}; // class mmsgs_pool
+
+} // namespace udpsrc::net
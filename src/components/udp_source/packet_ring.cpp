@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "packet_ring.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <linux/filter.h>
+#include <linux/net_tstamp.h>
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace udpsrc::net {
+
+namespace {
+
+constexpr uint32_t FRAME_SIZE = 2048;
+constexpr std::size_t IP_MIN_HEADER_LEN = 20;
+constexpr std::size_t UDP_HEADER_LEN = 8;
+constexpr int64_t NS_PER_SEC = 1'000'000'000;
+
+auto fail(std::string_view what) -> std::runtime_error {
+    return std::runtime_error("packet_ring: " + std::string{what} + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+packet_ring::packet_ring(
+    std::string_view interface,
+    std::string_view ip_addr,
+    uint16_t port,
+    uint32_t block_size,
+    uint32_t num_blocks,
+    uint32_t block_timeout_ms,
+    bool hardware_timestamps
+) {
+    // An empty address matches any destination, as for the UDP socket
+    auto dst_addr = uint32_t{};
+    if (!ip_addr.empty()) {
+        auto addr = in_addr{};
+        if (inet_pton(AF_INET, std::string{ip_addr}.c_str(), &addr) != 1) {
+            throw std::runtime_error("packet_ring: invalid ip_addr " + std::string{ip_addr});
+        }
+        dst_addr = ntohl(addr.s_addr);
+    }
+    // SOCK_DGRAM strips the link layer, so the filter and the frames start at
+    // the IP header. Protocol 0 receives nothing until bind.
+    m_fd = socket(AF_PACKET, SOCK_DGRAM, 0);
+    if (m_fd == -1) {
+        throw fail("socket");
+    }
+    auto version = int{TPACKET_V3};
+    if (setsockopt(m_fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) == -1) {
+        close(m_fd);
+        throw fail("PACKET_VERSION");
+    }
+    // Accept unfragmented IPv4/UDP to ip_addr:port (neither MF nor an offset)
+    //   ldb [9]; jeq #17; ld [16]; jeq #ip (ja +0 for any address); ldh [6];
+    //   jset #0x3fff; ldxb 4*([0]&0xf); ldh [x+2]; jeq #port; ret #-1; ret #0
+    auto match_addr = dst_addr != 0 ?
+        sock_filter BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, dst_addr, 0, 6) :
+        sock_filter BPF_JUMP(BPF_JMP | BPF_JA, 0, 0, 0);
+    auto filter = std::array<struct sock_filter, 11>{{
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 9),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_UDP, 0, 8),
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 16),
+        match_addr,
+        BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 6),
+        BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x3FFF, 4, 0),
+        BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, 0),
+        BPF_STMT(BPF_LD | BPF_H | BPF_IND, 2),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, port, 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, 0xFFFFFFFF),
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    }};
+    auto prog = sock_fprog{.len = static_cast<unsigned short>(filter.size()), .filter = filter.data()};
+    if (setsockopt(m_fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) == -1) {
+        close(m_fd);
+        throw fail("SO_ATTACH_FILTER");
+    }
+    // Locally sent datagrams would otherwise be seen again on the way out
+    // (on lo, or on every interface when none is given); next() also skips
+    // them for kernels without PACKET_IGNORE_OUTGOING
+    auto ignore = int{1};
+    setsockopt(m_fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &ignore, sizeof(ignore));
+    if (hardware_timestamps) {
+        // Frames fall back to software time if the NIC is not stamping
+        auto flags = int{SOF_TIMESTAMPING_RAW_HARDWARE};
+        setsockopt(m_fd, SOL_PACKET, PACKET_TIMESTAMP, &flags, sizeof(flags));
+    }
+    // Block ring
+    auto req = tpacket_req3{};
+    req.tp_block_size = block_size;
+    req.tp_block_nr = num_blocks;
+    req.tp_frame_size = FRAME_SIZE;
+    req.tp_frame_nr = (block_size / FRAME_SIZE) * num_blocks;
+    req.tp_retire_blk_tov = block_timeout_ms;
+    if (setsockopt(m_fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) == -1) {
+        close(m_fd);
+        throw fail("PACKET_RX_RING");
+    }
+    m_map_size = static_cast<std::size_t>(block_size) * num_blocks;
+    auto map = mmap(nullptr, m_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, m_fd, 0);
+    if (map == MAP_FAILED) {
+        close(m_fd);
+        throw fail("mmap");
+    }
+    m_map = static_cast<uint8_t*>(map);
+    m_blocks.reserve(num_blocks);
+    for (auto i=0u; i<num_blocks; ++i) {
+        auto blk = std::make_unique<block>();
+        blk->desc = reinterpret_cast<struct tpacket_block_desc*>(m_map + (static_cast<std::size_t>(i) * block_size));
+        blk->batch = batch::packet_batch(block_size / FRAME_SIZE);
+        m_blocks.emplace_back(std::move(blk));
+    }
+    // Start receiving
+    struct sockaddr_ll addr{};
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_IP);
+    addr.sll_ifindex = interface.empty() ? 0 : static_cast<int>(if_nametoindex(std::string{interface}.c_str()));
+    if (bind(m_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+        munmap(m_map, m_map_size);
+        close(m_fd);
+        throw fail("bind");
+    }
+}
+
+packet_ring::~packet_ring() {
+    munmap(m_map, m_map_size);
+    close(m_fd);
+}
+
+auto packet_ring::next() -> std::shared_ptr<batch::packet_batch> {
+    auto blk = m_blocks.at(m_block_idx).get();
+    // Still held downstream from the previous lap
+    if (blk->in_flight.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    auto& bh = blk->desc->hdr.bh1;
+    if ((__atomic_load_n(&bh.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) {
+        return nullptr;
+    }
+    // Collect views of the UDP payloads in this block
+    auto base = reinterpret_cast<const uint8_t*>(blk->desc);
+    blk->batch.reset(base);
+    auto frame_offset = std::size_t{bh.offset_to_first_pkt};
+    for (auto i=0u; i<bh.num_pkts; ++i) {
+        auto frame = reinterpret_cast<const struct tpacket3_hdr*>(base + frame_offset);
+        auto link = reinterpret_cast<const struct sockaddr_ll*>(base + frame_offset + TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+        if (link->sll_pkttype == PACKET_OUTGOING) {
+            frame_offset += frame->tp_next_offset;
+            continue;
+        }
+        auto ip = base + frame_offset + frame->tp_net;
+        auto ip_header_len = static_cast<std::size_t>(ip[0] & 0x0F) * 4;
+        if (ip_header_len >= IP_MIN_HEADER_LEN && frame->tp_snaplen >= ip_header_len + UDP_HEADER_LEN) {
+            uint16_t udp_len{};
+            std::memcpy(&udp_len, ip + ip_header_len + 4, sizeof(udp_len));
+            auto payload_len = std::min<std::size_t>(
+                ntohs(udp_len) - UDP_HEADER_LEN,
+                frame->tp_snaplen - ip_header_len - UDP_HEADER_LEN
+            );
+            blk->batch.push_back(
+                frame_offset + frame->tp_net + ip_header_len + UDP_HEADER_LEN,
+                payload_len,
+                (static_cast<int64_t>(frame->tp_sec) * NS_PER_SEC) + frame->tp_nsec
+            );
+        }
+        frame_offset += frame->tp_next_offset;
+    }
+    blk->in_flight.store(true, std::memory_order_relaxed);
+    m_block_idx = (m_block_idx + 1) % m_blocks.size();
+    auto owner = std::shared_ptr<block>(blk, [ring = shared_from_this()](block* released) {
+        ring->release(released);
+    });
+    return std::shared_ptr<batch::packet_batch>(std::move(owner), &blk->batch);
+}
+
+auto packet_ring::drops() -> uint64_t {
+    // The kernel resets its counters on every read
+    auto stats = tpacket_stats_v3{};
+    auto len = socklen_t{sizeof(stats)};
+    if (getsockopt(m_fd, SOL_PACKET, PACKET_STATISTICS, &stats, &len) == 0) {
+        m_drops += stats.tp_drops;
+    }
+    return m_drops;
+}
+
+auto packet_ring::held() const -> bool {
+    return m_blocks.at(m_block_idx)->in_flight.load(std::memory_order_acquire);
+}
+
+auto packet_ring::wait_released(std::chrono::milliseconds timeout) -> bool {
+    auto blk = m_blocks.at(m_block_idx).get();
+    auto lock = std::unique_lock(m_release_mutex);
+    return m_released.wait_for(lock, timeout, [blk]{ return !blk->in_flight.load(std::memory_order_acquire); });
+}
+
+auto packet_ring::release(block* blk) -> void {
+    __atomic_store_n(&blk->desc->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+    {
+        // Under the mutex so a waiter cannot miss the store between its check and its sleep
+        auto lock = std::lock_guard(m_release_mutex);
+        blk->in_flight.store(false, std::memory_order_release);
+    }
+    m_released.notify_one();
+}
+
+} // namespace udpsrc::net
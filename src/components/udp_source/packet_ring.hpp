@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <packet_batch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <linux/if_packet.h>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace udpsrc::net {
+
+/*
+ * AF_PACKET TPACKET_V3 receive ring. The kernel fills whole blocks with the
+ * datagrams accepted by a BPF filter on destination address and port. Each
+ * filled block is handed out as a batch of views onto the UDP payloads and is
+ * given back to the kernel when the last downstream owner releases it.
+ * Every frame carries its kernel (or, if requested, NIC) receive time.
+ */
+class packet_ring : public std::enable_shared_from_this<packet_ring> {
+public:
+    packet_ring(
+        std::string_view interface,
+        std::string_view ip_addr,
+        uint16_t port,
+        uint32_t block_size,
+        uint32_t num_blocks,
+        uint32_t block_timeout_ms,
+        bool hardware_timestamps = false
+    );
+    ~packet_ring();
+
+    packet_ring(const packet_ring&) = delete;
+    packet_ring& operator=(const packet_ring&) = delete;
+
+    auto fd() const -> int {
+        return m_fd;
+    }
+
+    // Next filled block, or nullptr if the kernel has not retired one yet
+    // or it is still held downstream
+    auto next() -> std::shared_ptr<batch::packet_batch>;
+
+    // Whether the next block is still held downstream from the previous lap
+    auto held() const -> bool;
+
+    // Waits for the next block to be released downstream; false on timeout
+    auto wait_released(std::chrono::milliseconds timeout) -> bool;
+
+    // Frames dropped by the kernel since the ring was opened, mostly because
+    // no block was free
+    auto drops() -> uint64_t;
+
+private:
+    struct block {
+        struct tpacket_block_desc* desc{nullptr};
+        batch::packet_batch batch;
+        std::atomic<bool> in_flight{false};
+    };
+
+    int m_fd{-1};
+    uint8_t* m_map{nullptr};
+    std::size_t m_map_size{};
+    std::vector<std::unique_ptr<block>> m_blocks;
+    std::size_t m_block_idx{};
+    uint64_t m_drops{};
+    std::mutex m_release_mutex;
+    std::condition_variable m_released;
+
+    auto release(block* blk) -> void;
+
+}; // class packet_ring
+
+} // namespace udpsrc::net
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace udpsrc {
+
+inline constexpr std::size_t CACHE_LINE = 64;
+
+/*
+ * Bounded lock-free single-producer/single-consumer ring. Each side keeps its
+ * own index and a cached copy of the other side's on a separate cache line,
+ * so the shared indices are only re-read when the ring looks full or empty.
+ */
+template <typename T>
+class spsc_ring {
+public:
+    explicit spsc_ring(std::size_t capacity) :
+      m_slots(std::bit_ceil(std::max<std::size_t>(capacity, 2))),
+      m_mask(m_slots.size() - 1) {}
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    // Producer
+    auto try_push(T&& value) -> bool {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cached_head == m_slots.size()) {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+            if (tail - m_cached_head == m_slots.size()) {
+                return false;
+            }
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer
+    auto try_pop(T& value) -> bool {
+        auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cached_tail) {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cached_tail) {
+                return false;
+            }
+        }
+        value = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer
+    auto empty() const -> bool {
+        return m_head.load(std::memory_order_relaxed) == m_tail.load(std::memory_order_acquire);
+    }
+
+    auto capacity() const -> std::size_t {
+        return m_slots.size();
+    }
+
+private:
+    std::vector<T> m_slots;
+    std::size_t m_mask;
+
+    // Consumer side
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_head{};
+    std::size_t m_cached_tail{};
+
+    // Producer side
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_tail{};
+    std::size_t m_cached_head{};
+
+}; // class spsc_ring
+
+} // namespace udpsrc
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "uring_receiver.hpp"
+#include "control_msgs.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace udpsrc::net {
+
+namespace {
+
+auto fail(std::string_view what, int err) -> std::runtime_error {
+    return std::runtime_error("uring_receiver: " + std::string{what} + ": " + std::strerror(err));
+}
+
+} // namespace
+
+uring_receiver::uring_receiver(int fd, uint32_t msg_size, uint32_t num_msgs, uint32_t pool_size) :
+  m_fd(fd),
+  m_cqes(num_msgs) {
+    // Each provided buffer holds the recvmsg header, the control data, then
+    // the payload; no name is requested
+    m_msg.msg_controllen = CONTROL_SIZE;
+    auto header_size = static_cast<uint32_t>(sizeof(struct io_uring_recvmsg_out) + m_msg.msg_controllen);
+    m_buf_size = (header_size + msg_size + 63) & ~uint32_t{63};
+    // Clamped before rounding, in 64 bits, so large pools cannot overflow
+    auto wanted = std::min<uint64_t>(uint64_t{num_msgs} * pool_size, MAX_BUFS);
+    m_num_bufs = static_cast<uint32_t>(std::bit_ceil(std::max<uint64_t>(wanted, 1)));
+    // Every provided buffer can be sitting in the CQ at once; the default CQ
+    // of twice the submission depth would overflow long before that
+    auto params = io_uring_params{};
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = std::max(m_num_bufs, 2 * QUEUE_DEPTH);
+    if (auto ret = io_uring_queue_init_params(QUEUE_DEPTH, &m_ring, &params); ret < 0) {
+        throw fail("io_uring_queue_init_params", -ret);
+    }
+    auto ret = int{};
+    m_buf_ring = io_uring_setup_buf_ring(&m_ring, m_num_bufs, BUF_GROUP, 0, &ret);
+    if (m_buf_ring == nullptr) {
+        io_uring_queue_exit(&m_ring);
+        throw fail("io_uring_setup_buf_ring", -ret);
+    }
+    auto bytes = static_cast<std::size_t>(m_buf_size) * m_num_bufs;
+    m_buffers = static_cast<uint8_t*>(std::aligned_alloc(4096, (bytes + 4095) & ~std::size_t{4095}));
+    if (m_buffers == nullptr) {
+        io_uring_free_buf_ring(&m_ring, m_buf_ring, m_num_bufs, BUF_GROUP);
+        io_uring_queue_exit(&m_ring);
+        throw fail("aligned_alloc", ENOMEM);
+    }
+    auto mask = io_uring_buf_ring_mask(m_num_bufs);
+    for (auto bid=0u; bid<m_num_bufs; ++bid) {
+        io_uring_buf_ring_add(m_buf_ring, m_buffers + (static_cast<std::size_t>(bid) * m_buf_size), m_buf_size, bid, mask, bid);
+    }
+    io_uring_buf_ring_advance(m_buf_ring, m_num_bufs);
+    m_in_ring = m_num_bufs;
+    // Batch slots and buffer id lists are sized up front so recycling never allocates
+    m_free.reserve(pool_size);
+    for (auto i=0u; i<pool_size; ++i) {
+        auto s = std::make_unique<slot>();
+        s->batch = batch::packet_batch(num_msgs);
+        s->bids.reserve(num_msgs);
+        m_free.emplace_back(std::move(s));
+    }
+    m_returned.reserve(m_num_bufs);
+    m_recycle.reserve(m_num_bufs);
+    arm();
+}
+
+uring_receiver::~uring_receiver() {
+    io_uring_free_buf_ring(&m_ring, m_buf_ring, m_num_bufs, BUF_GROUP);
+    io_uring_queue_exit(&m_ring);
+    std::free(m_buffers);
+}
+
+auto uring_receiver::receive(std::chrono::milliseconds timeout) -> std::shared_ptr<batch::packet_batch> {
+    // A multishot is only re-armed while the ring has buffers to give it,
+    // otherwise it would terminate with -ENOBUFS again straight away
+    recycle();
+    if (!m_armed && m_in_ring > 0) {
+        arm();
+    }
+    auto s = std::unique_ptr<slot>{};
+    {
+        auto lk = std::scoped_lock{m_mtx};
+        if (m_free.empty()) {
+            return nullptr;
+        }
+        s = std::move(m_free.back());
+        m_free.pop_back();
+    }
+    auto count = io_uring_peek_batch_cqe(&m_ring, m_cqes.data(), m_cqes.size());
+    if (count == 0) {
+        // Only an idle ring enters the kernel
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        auto ts = __kernel_timespec{
+            .tv_sec = secs.count(),
+            .tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - secs).count()
+        };
+        auto cqe = static_cast<struct io_uring_cqe*>(nullptr);
+        if (io_uring_wait_cqe_timeout(&m_ring, &cqe, &ts) == 0) {
+            count = io_uring_peek_batch_cqe(&m_ring, m_cqes.data(), m_cqes.size());
+        }
+    }
+    s->batch.reset(m_buffers);
+    s->bids.clear();
+    for (auto i=0u; i<count; ++i) {
+        auto cqe = m_cqes.at(i);
+        if ((cqe->flags & IORING_CQE_F_MORE) == 0) {
+            // Multishot terminated, e.g. -ENOBUFS while every buffer is downstream
+            m_armed = false;
+        }
+        if ((cqe->flags & IORING_CQE_F_BUFFER) == 0) {
+            continue;
+        }
+        --m_in_ring;
+        auto bid = static_cast<uint16_t>(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        s->bids.push_back(bid);
+        if (cqe->res < 0) {
+            continue;
+        }
+        auto buf = m_buffers + (static_cast<std::size_t>(bid) * m_buf_size);
+        auto out = io_uring_recvmsg_validate(buf, cqe->res, &m_msg);
+        if (out == nullptr) {
+            continue;
+        }
+        auto payload = static_cast<uint8_t*>(io_uring_recvmsg_payload(out, &m_msg));
+        auto timestamp = int64_t{};
+        if (auto cmsg = io_uring_recvmsg_cmsg_firsthdr(out, &m_msg); cmsg != nullptr) {
+            auto control = msghdr{};
+            control.msg_control = cmsg;
+            control.msg_controllen = out->controllen;
+            timestamp = kernel_timestamp(control);
+            if (auto drops = kernel_drops(control)) {
+                m_drops = *drops;
+            }
+        }
+        s->batch.push_back(
+            payload - m_buffers,
+            io_uring_recvmsg_payload_length(out, cqe->res, &m_msg),
+            timestamp
+        );
+    }
+    io_uring_cq_advance(&m_ring, count);
+    if (s->batch.empty()) {
+        release(s.release());
+        return nullptr;
+    }
+    auto raw = s.release();
+    auto owner = std::shared_ptr<slot>(raw, [receiver = shared_from_this()](slot* released) {
+        receiver->release(released);
+    });
+    return std::shared_ptr<batch::packet_batch>(std::move(owner), &raw->batch);
+}
+
+auto uring_receiver::arm() -> void {
+    auto sqe = io_uring_get_sqe(&m_ring);
+    if (sqe == nullptr) {
+        return;
+    }
+    io_uring_prep_recvmsg_multishot(sqe, m_fd, &m_msg, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUF_GROUP;
+    m_armed = io_uring_submit(&m_ring) >= 0;
+}
+
+auto uring_receiver::recycle() -> void {
+    // The buffer ring has a single producer, so buffers released by consumers
+    // are queued and handed back to the kernel from the receiving thread
+    {
+        auto lk = std::scoped_lock{m_mtx};
+        if (m_returned.empty()) {
+            return;
+        }
+        m_recycle.swap(m_returned);
+    }
+    auto mask = io_uring_buf_ring_mask(m_num_bufs);
+    auto offset = 0;
+    for (auto bid : m_recycle) {
+        io_uring_buf_ring_add(m_buf_ring, m_buffers + (static_cast<std::size_t>(bid) * m_buf_size), m_buf_size, bid, mask, offset++);
+    }
+    io_uring_buf_ring_advance(m_buf_ring, offset);
+    m_in_ring += static_cast<uint32_t>(offset);
+    m_recycle.clear();
+}
+
+auto uring_receiver::release(slot* released) -> void {
+    auto lk = std::scoped_lock{m_mtx};
+    m_returned.insert(m_returned.end(), released->bids.begin(), released->bids.end());
+    m_free.emplace_back(released);
+}
+
+} // namespace udpsrc::net
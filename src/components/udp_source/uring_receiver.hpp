@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <packet_batch.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <liburing.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace udpsrc::net {
+
+/*
+ * io_uring multishot recvmsg receiver. Datagrams land in a provided-buffer
+ * ring registered with the kernel, so a running receive needs no syscall per
+ * batch. Completions are gathered into batches of up to num_msgs views onto
+ * those buffers; the buffers go back to the ring once the batch is released.
+ * Every buffer has room for the timestamp and drop counter cmsgs.
+ */
+class uring_receiver : public std::enable_shared_from_this<uring_receiver> {
+public:
+    uring_receiver(int fd, uint32_t msg_size, uint32_t num_msgs, uint32_t pool_size);
+    ~uring_receiver();
+
+    uring_receiver(const uring_receiver&) = delete;
+    uring_receiver& operator=(const uring_receiver&) = delete;
+
+    // Completed datagrams, waiting up to timeout when none are ready
+    auto receive(std::chrono::milliseconds timeout) -> std::shared_ptr<batch::packet_batch>;
+
+    // Socket overflow drops last reported by the kernel
+    auto drops() const -> uint64_t {
+        return m_drops;
+    }
+
+private:
+    static constexpr int BUF_GROUP = 0;
+    static constexpr uint32_t MAX_BUFS = 32768;
+    static constexpr uint32_t QUEUE_DEPTH = 64;
+
+    struct slot {
+        batch::packet_batch batch;
+        std::vector<uint16_t> bids;
+    };
+
+    int m_fd{-1};
+    uint32_t m_buf_size{};
+    uint32_t m_num_bufs{};
+    struct io_uring m_ring{};
+    struct io_uring_buf_ring* m_buf_ring{nullptr};
+    uint8_t* m_buffers{nullptr};
+    struct msghdr m_msg{};
+    bool m_armed{false};
+    // Provided buffers the kernel can still fill
+    uint32_t m_in_ring{};
+    uint64_t m_drops{};
+    std::vector<struct io_uring_cqe*> m_cqes;
+    std::vector<uint16_t> m_recycle;
+
+    // Shared with releasing consumers
+    std::mutex m_mtx;
+    std::vector<std::unique_ptr<slot>> m_free;
+    std::vector<uint16_t> m_returned;
+
+    auto arm() -> void;
+    auto recycle() -> void;
+    auto release(slot* released) -> void;
+
+}; // class uring_receiver
+
+} // namespace udpsrc::net
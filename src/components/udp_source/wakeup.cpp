@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "wakeup.hpp"
+
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace udpsrc {
+
+wakeup::wakeup(strategy strat) : m_strategy(strat) {
+    if (m_strategy == strategy::EVENTFD) {
+        m_eventfd = eventfd(0, EFD_NONBLOCK);
+    }
+}
+
+wakeup::~wakeup() {
+    if (m_eventfd != -1) {
+        close(m_eventfd);
+    }
+}
+
+auto wakeup::parse(std::string_view name) -> strategy {
+    if (name == "spin") {
+        return strategy::SPIN;
+    } else if (name == "eventfd") {
+        return strategy::EVENTFD;
+    }
+    return strategy::FUTEX;
+}
+
+auto wakeup::notify() -> void {
+    if (m_strategy == strategy::SPIN) {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!m_waiting.load(std::memory_order_relaxed)) {
+        return;
+    }
+    m_seq.fetch_add(1, std::memory_order_release);
+    if (m_strategy == strategy::FUTEX) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_seq), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    } else {
+        auto one = uint64_t{1};
+        [[maybe_unused]] auto res = write(m_eventfd, &one, sizeof(one));
+    }
+}
+
+auto wakeup::sleep(uint32_t seq, std::chrono::milliseconds timeout) -> void {
+    if (m_strategy == strategy::FUTEX) {
+        // Returns at once if a producer bumped the sequence since it was read
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        auto ts = timespec{
+            .tv_sec = secs.count(),
+            .tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - secs).count()
+        };
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_seq), FUTEX_WAIT_PRIVATE, seq, &ts, nullptr, 0);
+    } else {
+        auto pfd = pollfd{.fd = m_eventfd, .events = POLLIN, .revents = 0};
+        if (poll(&pfd, 1, static_cast<int>(timeout.count())) > 0) {
+            auto count = uint64_t{};
+            [[maybe_unused]] auto res = read(m_eventfd, &count, sizeof(count));
+        }
+    }
+}
+
+} // namespace udpsrc
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <immintrin.h>
+#include <string_view>
+
+namespace udpsrc {
+
+/*
+ * Consumer wakeup for lock-free handoffs. The consumer only sleeps after
+ * announcing itself and re-checking its condition, and producers only make a
+ * syscall when a consumer has announced itself, so the handoff stays free of
+ * syscalls while the consumer keeps up.
+ */
+class wakeup {
+public:
+    enum class strategy {
+        SPIN,    // busy-wait, lowest latency, burns the consumer core
+        FUTEX,   // sleep on a futex word
+        EVENTFD  // sleep in poll() on an eventfd
+    };
+
+    explicit wakeup(strategy strat);
+    ~wakeup();
+
+    wakeup(const wakeup&) = delete;
+    wakeup& operator=(const wakeup&) = delete;
+
+    static auto parse(std::string_view name) -> strategy;
+
+    // Producer, after publishing
+    auto notify() -> void;
+
+    // Consumer, true once ready() holds, false on timeout
+    template <typename Pred>
+    auto wait(Pred ready, std::chrono::milliseconds timeout) -> bool {
+        if (ready()) {
+            return true;
+        }
+        if (m_strategy == strategy::SPIN) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (!ready()) {
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    return false;
+                }
+                _mm_pause();
+            }
+            return true;
+        }
+        auto seq = m_seq.load(std::memory_order_acquire);
+        m_waiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ready()) {
+            ++m_sleeps;
+            sleep(seq, timeout);
+        }
+        m_waiting.store(false, std::memory_order_relaxed);
+        return ready();
+    }
+
+    // Number of times the consumer went to sleep
+    auto sleeps() const -> uint64_t {
+        return m_sleeps;
+    }
+
+private:
+    strategy m_strategy;
+    int m_eventfd{-1};
+    std::atomic<uint32_t> m_seq{};
+    std::atomic<bool> m_waiting{false};
+    uint64_t m_sleeps{};
+
+    auto sleep(uint32_t seq, std::chrono::milliseconds timeout) -> void;
+
+}; // class wakeup
+
+} // namespace udpsrc
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2024 Geon Technologies, LLC
+ *
+ * This file is part of composite-comps.
+ *
+ * composite-comps is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * composite-comps is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+/*
+ * Pre-generates FFTW wisdom for the fft component, so pipelines using the
+ * same wisdom_file start without measuring.
+ *
+ *   fft_wisdom --wisdom FILE [--planner PATIENT] [--threads 1]
+ *              [--types f32,f64] [--sizes 1024,2048,...,65536]
+ *
+ * Plans the forward complex and real transforms of every size for each type,
+ * covering all fft_plan specializations. Like the component, float wisdom
+ * goes to FILE with an "f" appended.
+ */
+
+#include <fft_plan.hpp>
+#include <wisdom.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr auto DEFAULT_SIZES = "1024,2048,4096,8192,16384,32768,65536";
+
+auto split(const std::string& list) -> std::vector<std::string> {
+    auto items = std::vector<std::string>{};
+    auto start = std::size_t{};
+    while (start <= list.size()) {
+        auto end = std::min(list.find(',', start), list.size());
+        if (end > start) {
+            items.emplace_back(list.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return items;
+}
+
+template <typename T>
+auto plan_all(const std::vector<uint32_t>& sizes, uint32_t threads, unsigned flags, const std::string& file) -> void {
+    for (auto size : sizes) {
+        auto start = std::chrono::steady_clock::now();
+        {
+            auto complex = fft_plan<T, true>(size, threads, false, flags, file);
+            auto real = fft_plan<T, false>(size, threads, false, flags, file);
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-4s %8u  %8.2f s  -> %s\n", sizeof(T) == 4 ? "f32" : "f64", size, elapsed, wisdom::path<T>(file).c_str());
+    }
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    auto opts = std::map<std::string, std::string>{};
+    for (auto i=1; i+1<argc; i+=2) {
+        opts[argv[i]] = argv[i + 1];
+    }
+    auto get = [&opts](const std::string& key, const std::string& fallback) {
+        auto it = opts.find(key);
+        return it == opts.end() ? fallback : it->second;
+    };
+    auto file = get("--wisdom", "");
+    auto flags = wisdom::parse_planner(get("--planner", "PATIENT"));
+    if (file.empty() || !flags || (*flags & FFTW_ESTIMATE) != 0) {
+        std::fprintf(stderr, "usage: %s --wisdom FILE [--planner MEASURE|PATIENT|EXHAUSTIVE] [--threads N] [--types f32,f64] [--sizes N,...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    auto threads = static_cast<uint32_t>(std::strtoul(get("--threads", "1").c_str(), nullptr, 10));
+    auto sizes = std::vector<uint32_t>{};
+    for (const auto& size : split(get("--sizes", DEFAULT_SIZES))) {
+        sizes.push_back(static_cast<uint32_t>(std::strtoul(size.c_str(), nullptr, 0)));
+    }
+    for (const auto& type : split(get("--types", "f32,f64"))) {
+        if (type == "f32") {
+            plan_all<float>(sizes, threads, *flags, file);
+        } else if (type == "f64") {
+            plan_all<double>(sizes, threads, *flags, file);
+        } else {
+            std::fprintf(stderr, "unknown type %s\n", type.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}